@@ -1,168 +1,211 @@
 #include "BigInt.h"
+#include "BigIntLimbs.h"
+#include "BigIntView.h"
 
 #include <cstdlib>
-#include <stack>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+#include <memory>
 #include <new>
+#include <stdexcept>
 #include <ostream>
 #include <cassert>
 
 // -----------------------
-// -- Internal Constants for CMP
+// -- Internal Constants for buffer growth
 // -----------------------
 
-const int CMP_SECOND_PARAMETER_SMALLER = -1;
-const int CMP_SECOND_PARAMETER_BIGGER = 1;
-const int CMP_EQUAL = 0;
+// buffers grow by at least capacity / GROWTH_DIVISOR limbs, so repeated small growths copy every limb O(1) times
+// there is no lower bound, the inline limbs already cover the small sizes
+static const std::size_t GROWTH_DIVISOR = 2;
+
+using namespace bigint_limbs;
 
 // -----------------------
-// -- Internal Util functions
+// -- Internal Util functions for decimal conversion
 // -----------------------
-static void decrease_size(unsigned short*& digits, int old_size, int new_size) {
-	assert(old_size > new_size);
 
-	unsigned short* tmp_array = new unsigned short[new_size] {};
-	for (int i = 0; i < new_size; i++) {
-		tmp_array[i] = digits[i];
-	}
-	delete[] digits;
-	digits = tmp_array;
-}
+// number of characters of the chunks as text, the most significant chunk has no leading zeros
+static std::size_t decimal_length(const limb_vector& chunks, bool is_negative)
+{
+	std::size_t top_digits = 1;
+	for (limb_t top = chunks.back(); top >= 10; top /= 10)
+		top_digits++;
 
-static void increase_size(unsigned short*& digits, int old_size, int new_size) {
-	assert(new_size > old_size);
+	return (is_negative ? 1 : 0) + top_digits + DECIMAL_CHUNK_DIGITS * (chunks.size() - 1);
+}
 
-	unsigned short* tmp_array = new unsigned short[new_size] {};
-	for (int i = 0; i < old_size; i++) {
-		tmp_array[i] = digits[i];
+// writes decimal_length(chunks, is_negative) characters to text
+static void write_decimal(char* text, const limb_vector& chunks, bool is_negative)
+{
+	char* end = text + decimal_length(chunks, is_negative);
+	if (is_negative)
+		*text = '-';
+
+	// fill from the back, every chunk but the most significant one has exactly 9 digits
+	for (std::size_t i = 0; i < chunks.size(); i++) {
+		limb_t chunk = chunks[i];
+		bool is_top = i + 1 == chunks.size();
+		for (int j = 0; j < DECIMAL_CHUNK_DIGITS && (!is_top || chunk > 0 || j == 0); j++) {
+			*--end = static_cast<char>('0' + chunk % 10);
+			chunk /= 10;
+		}
 	}
-	delete[] digits;
-	digits = tmp_array;
 }
 
 // -----------------------
 // -- Util methods
 // -----------------------
 /// <summary>
-/// Adds two BigInts and returns a new object
+/// Adds the absolute values of two BigInts and returns a new object
 /// </summary>
 BigInt add(const BigInt& b1, const BigInt& b2)
 {
-	int max_length_parameters = b1.length > b2.length ? b1.length : b2.length;
-	unsigned short* destination_digits = new unsigned short[max_length_parameters] {};
-	unsigned short current_length = max_length_parameters;
-
-	for (int i = 0; i < current_length; i++) {
-		// 1. calc sum
-		unsigned short sum = b1.get_digit_or_default(i) + b2.get_digit_or_default(i);
-
-		// 2. calc current
-		unsigned short current = sum % 10;
-		// use += instead of = because last iteration could have set carry on this position
-		destination_digits[i] += current;
-
-		// 3. calc carry
-		unsigned short carry = sum / 10;
-		// nothind to do in this iteration if there is no carry
-		bool no_carry = carry == 0;
-		if (no_carry)
-			continue;
-
-		// check size
-		bool need_increase_size = i + 1 > (current_length - 1);
-		if (need_increase_size) {
-			increase_size(destination_digits, current_length, current_length + 1);
-			current_length++;
-		}
+	bool is_b1_longer = b1.length >= b2.length;
+	const BigInt& longer = is_b1_longer ? b1 : b2;
+	const BigInt& shorter = is_b1_longer ? b2 : b1;
 
-		// set carry value
-		destination_digits[i + 1] = carry;
-	}
+	// reserve one more limb for the last carry
+	BigInt sum(longer.length + 1, false, BigInt::default_resource());
+	sum.limbs[longer.length] = bigint_limbs::add(sum.limbs, longer.limbs, longer.length, shorter.limbs, shorter.length);
 
-	return BigInt(destination_digits, current_length, false);
+	sum.normalize();
+	return sum;
 }
 
 /// <summary>
-/// Subtracts two BigInts and returns a new object
+/// Subtracts the absolute values of two BigInts and returns a new object
 /// </summary>
 BigInt substract(const BigInt& b1, const BigInt& b2)
 {
-	int max_length_parameters = b1.length > b2.length ? b1.length : b2.length;
-	unsigned short* destination_digits = new unsigned short[max_length_parameters] {};
-	unsigned short current_length = max_length_parameters;
+	assert(b1.cmp_absolute(b2) != CMP_SECOND_PARAMETER_BIGGER);
 
-	unsigned short carry = 0;
+	BigInt difference(b1.length, false, BigInt::default_resource());
+	bigint_limbs::sub(difference.limbs, b1.limbs, b1.length, b2.limbs, b2.length);
 
-	for (int i = 0; i < current_length; i++) {
-		// 1. calc sum
-		short diff = b1.get_digit_or_default(i) - b2.get_digit_or_default(i) - carry;
-		bool is_diff_negative = diff < 0;
+	difference.normalize();
+	return difference;
+}
 
-		// 2. calc current
-		unsigned short current = is_diff_negative ? diff + 10 : diff;
-		destination_digits[i] = current;
+// -----------------------
+// -- Memory resources
+// -----------------------
 
-		// 3. calc carry 
-		carry = is_diff_negative == true;
-	}
+// nullptr stands for std::pmr::get_default_resource(), which can still change after the thread started
+static thread_local std::pmr::memory_resource* thread_resource = nullptr;
 
-	// 4. remove leading zeros
-	// we could improve this algorithm by calculating the new size BEFORE shrinking the array
-	// so we could shrink it in one statement
-	for (int i = 1; i < current_length && current_length > 1; i++) {
-		bool leading_zero = destination_digits[current_length - i] == 0;
-		if (leading_zero) {
-			decrease_size(destination_digits, current_length, current_length - i);
-			current_length--;
-			i--;
-		}
-		else {
-			break;
-		}
-	}
+std::pmr::memory_resource* BigInt::default_resource()
+{
+	return thread_resource != nullptr ? thread_resource : std::pmr::get_default_resource();
+}
 
-	return BigInt(destination_digits, current_length, false);
+std::pmr::memory_resource* BigInt::set_default_resource(std::pmr::memory_resource* resource)
+{
+	std::pmr::memory_resource* previous = default_resource();
+	thread_resource = resource;
+	return previous;
 }
 
 // -----------------------
 // -- Constructor, Destructor, Copy Constructor and Assignment Operator
 // -----------------------
 
-BigInt::BigInt(long int value) : is_negative(false), length(0)
+BigInt::BigInt(long int value, std::pmr::memory_resource* resource) : is_negative(value < 0), length(0), capacity(INLINE_LIMBS), limbs(inline_limbs), resource(resource)
 {
-	if (value < 0) {
-		is_negative = true;
-		value *= -1;
-	}
+	// negate unsigned so the minimum long value does not overflow
+	unsigned long long magnitude = is_negative ? 0ULL - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
 
-	if (value == 0) {
-		length = 1;
+	static_assert(sizeof(magnitude) / sizeof(limb_t) <= INLINE_LIMBS, "a long has to fit into the inline limbs");
+	while (magnitude > 0) {
+		limbs[length] = static_cast<limb_t>(magnitude);
+		magnitude >>= LIMB_BITS;
+		length++;
 	}
+}
 
-	digits = new unsigned short[length] {};
-	while (value > 0) {
-		increase_size(digits, length, length + 1);
-		unsigned short current_digit = value % 10;
-		digits[length] = current_digit;
-		value /= 10;
-		length++;
+BigInt::BigInt(unsigned short* digits, std::size_t length, bool is_negative, std::pmr::memory_resource* resource) : is_negative(is_negative), length(0), capacity(INLINE_LIMBS), limbs(inline_limbs), resource(resource)
+{
+	std::unique_ptr<unsigned short[]> owned_digits(digits);
+
+	// group the digits into chunks of 9, the first chunk holds the least significant digits
+	limb_vector chunks((length + DECIMAL_CHUNK_DIGITS - 1) / DECIMAL_CHUNK_DIGITS);
+	for (std::size_t i = 0; i < chunks.size(); i++) {
+		std::size_t chunk_start = i * DECIMAL_CHUNK_DIGITS;
+		std::size_t chunk_end = std::min<std::size_t>(chunk_start + DECIMAL_CHUNK_DIGITS, length);
+		limb_t chunk = 0;
+		for (std::size_t j = chunk_end; j-- > chunk_start;) {
+			assert(digits[j] < 10);
+			chunk = chunk * 10 + digits[j];
+		}
+		chunks[i] = chunk;
 	}
+
+	ensure_capacity(limbs_for_decimal_chunks(chunks.size()));
+	this->length = from_decimal_chunks(limbs, chunks.data(), chunks.size());
+	normalize();
+}
+
+BigInt::BigInt(std::size_t length, bool is_negative, std::pmr::memory_resource* resource) : is_negative(is_negative), length(0), capacity(INLINE_LIMBS), limbs(inline_limbs), resource(resource)
+{
+	ensure_capacity(length);
+	std::fill(limbs, limbs + length, 0);
+	this->length = length;
 }
 
-BigInt::BigInt(unsigned short* digits, unsigned short length, bool is_negative) : digits(digits), length(length), is_negative(is_negative)
+BigInt::BigInt(const BigIntView& view, std::pmr::memory_resource* resource) : is_negative(view.get_is_negative()), length(0), capacity(INLINE_LIMBS), limbs(inline_limbs), resource(resource)
 {
+	ensure_capacity(view.get_length());
+	std::copy(view.get_limbs(), view.get_limbs() + view.get_length(), limbs);
+	length = view.get_length();
+}
+
+BigInt::BigInt(const Product& product, std::pmr::memory_resource* resource) : is_negative(product.a.is_negative != product.b.is_negative), length(0), capacity(INLINE_LIMBS), limbs(inline_limbs), resource(resource)
+{
+	BIGINT_STATS_SCOPE(OP_MUL, product.max_length());
+
+	// the product of two numbers never has more limbs than both together
+	std::size_t product_length = product.a.length + product.b.length;
+	ensure_capacity(product_length);
+	bigint_limbs::mul(limbs, product.a.limbs, product.a.length, product.b.limbs, product.b.length);
+	length = product_length;
+	normalize();
 }
 
 // destructor
 BigInt::~BigInt()
 {
-	delete[] digits;
+	release();
 }
 
 // copy constructor
-BigInt::BigInt(const BigInt& b) : digits(new unsigned short[b.length]), length(b.length), is_negative(b.is_negative)
+BigInt::BigInt(const BigInt& b) : BigInt(b, default_resource())
 {
-	for (int i = 0; i < b.length; i++)
-		digits[i] = b.digits[i];
+}
+
+BigInt::BigInt(const BigInt& b, std::pmr::memory_resource* resource) : is_negative(b.is_negative), length(0), capacity(INLINE_LIMBS), limbs(inline_limbs), resource(resource)
+{
+	ensure_capacity(b.length);
+	length = b.length;
+	if (length > 0)
+		memcpy(limbs, b.limbs, sizeof(limb_t) * length);
+}
+
+// move constructor
+BigInt::BigInt(BigInt&& b) noexcept : is_negative(b.is_negative), length(b.length), capacity(INLINE_LIMBS), limbs(inline_limbs), resource(b.resource)
+{
+	if (b.is_inline()) {
+		memcpy(inline_limbs, b.inline_limbs, sizeof(limb_t) * length);
+	}
+	else {
+		limbs = b.limbs;
+		capacity = b.capacity;
+		b.limbs = b.inline_limbs;
+		b.capacity = INLINE_LIMBS;
+	}
+
+	b.is_negative = false;
+	b.length = 0;
 }
 
 // assignment operator
@@ -173,37 +216,196 @@ BigInt& BigInt::operator=(const BigInt& b)
 		return *this;
 	}
 
-	if (length != b.length) {
-		delete digits;
-		digits = new unsigned short[b.length];
-	}
+	// keep our buffer if the value fits into it, our old value does not need to be copied over
+	length = 0;
+	ensure_capacity(b.length);
 
 	length = b.length;
 	is_negative = b.is_negative;
 
-	for (int i = 0; i < length; i++)
-		digits[i] = b.digits[i];
+	if (length > 0)
+		memcpy(limbs, b.limbs, sizeof(limb_t) * length);
+
+	return *this;
+}
+
+// move assignment operator
+BigInt& BigInt::operator=(BigInt&& b)
+{
+	if (this == &b)
+		return *this;
+
+	// a buffer can only change hands if we could also free it
+	bool same_resource = resource == b.resource || resource->is_equal(*b.resource);
+	if (b.is_inline() || !same_resource) {
+		*this = static_cast<const BigInt&>(b);
+	}
+	else {
+		release();
+		limbs = b.limbs;
+		capacity = b.capacity;
+		length = b.length;
+		is_negative = b.is_negative;
+		b.limbs = b.inline_limbs;
+		b.capacity = INLINE_LIMBS;
+	}
+
+	b.is_negative = false;
+	b.length = 0;
 
 	return *this;
 }
 
+void BigInt::normalize()
+{
+	while (length > 0 && limbs[length - 1] == 0)
+		length--;
+
+	if (length == 0)
+		is_negative = false;
+}
+
+void BigInt::ensure_capacity(std::size_t new_capacity)
+{
+	if (new_capacity <= capacity)
+		return;
+
+	if (new_capacity > MAX_LIMBS)
+		throw std::length_error("BigInt would exceed BigInt::MAX_LIMBS limbs");
+
+	// the old buffer is only released after the new one was allocated, so a failure keeps the value
+	new_capacity = std::max(new_capacity, std::min(capacity + capacity / GROWTH_DIVISOR, MAX_LIMBS));
+
+	BIGINT_STATS_SCOPE(OP_GROW, length);
+	BIGINT_STATS_ALLOCATION(sizeof(limb_t) * new_capacity);
+	limb_t* new_limbs = static_cast<limb_t*>(resource->allocate(sizeof(limb_t) * new_capacity, alignof(limb_t)));
+	if (length > 0)
+		memcpy(new_limbs, limbs, sizeof(limb_t) * length);
+
+	std::size_t old_length = length;
+	release();
+	limbs = new_limbs;
+	capacity = new_capacity;
+	length = old_length;
+}
+
+void BigInt::release()
+{
+	if (!is_inline())
+		resource->deallocate(limbs, sizeof(limb_t) * capacity, alignof(limb_t));
+
+	limbs = inline_limbs;
+	capacity = INLINE_LIMBS;
+	length = 0;
+}
+
+void BigInt::reserve(std::size_t limb_count)
+{
+	ensure_capacity(limb_count);
+}
+
+void BigInt::shrink_to_fit()
+{
+	if (is_inline() || capacity == length)
+		return;
+
+	// small values go back to the inline limbs
+	if (length > INLINE_LIMBS)
+		BIGINT_STATS_ALLOCATION(sizeof(limb_t) * length);
+	limb_t* new_limbs = length <= INLINE_LIMBS ? inline_limbs : static_cast<limb_t*>(resource->allocate(sizeof(limb_t) * length, alignof(limb_t)));
+	if (length > 0)
+		memcpy(new_limbs, limbs, sizeof(limb_t) * length);
+
+	std::size_t old_length = length;
+	release();
+	limbs = new_limbs;
+	capacity = std::max(old_length, INLINE_LIMBS);
+	length = old_length;
+}
+
+void BigInt::add_signed(const BigIntView& b, bool b_is_negative)
+{
+	std::size_t b_length = b.get_length();
+	if (is_negative == b_is_negative) {
+		// b may view ourself, then it follows our limbs when the buffer grows
+		bool is_self = b.get_limbs() == limbs;
+
+		// keep sign if both are the same sign and add
+		std::size_t max_length = std::max(length, b_length);
+		ensure_capacity(max_length + 1);
+		std::fill(limbs + length, limbs + max_length, 0);
+
+		limbs[max_length] = bigint_limbs::add(limbs, limbs, max_length, is_self ? limbs : b.get_limbs(), b_length);
+		length = max_length + 1;
+		normalize();
+		return;
+	}
+
+	// if the signs are different, subtract the numbers and use the sign of the largest number
+	bool is_a_larger = cmp_absolute(b) != CMP_SECOND_PARAMETER_BIGGER;
+	if (is_a_larger) {
+		bigint_limbs::sub(limbs, limbs, length, b.get_limbs(), b_length);
+	}
+	else {
+		ensure_capacity(b_length);
+		bigint_limbs::sub(limbs, b.get_limbs(), b_length, limbs, length);
+		length = b_length;
+		is_negative = b_is_negative;
+	}
+
+	// takes care of -0
+	normalize();
+}
+
+void BigInt::add_product(const BigInt& a, const BigInt& b, bool is_subtraction)
+{
+	// the kernels read a and b while they write our limbs
+	if (this == &a || this == &b) {
+		BigInt product(Product(a, b), resource);
+		add_signed(product, product.is_negative != is_subtraction);
+		return;
+	}
+
+	if (a.length == 0 || b.length == 0)
+		return;
+
+	BIGINT_STATS_SCOPE(OP_MUL, a.length + b.length);
+
+	// room for the longer of both plus the carry, the product is computed on the absolute values
+	bool is_product_negative = (a.is_negative != b.is_negative) != is_subtraction;
+	std::size_t max_length = std::max(length, a.length + b.length) + 1;
+	ensure_capacity(max_length);
+	std::fill(limbs + length, limbs + max_length, 0);
+	length = max_length;
+
+	if (is_negative == is_product_negative) {
+		bigint_limbs::addmul(limbs, length, a.limbs, a.length, b.limbs, b.length);
+	}
+	else if (bigint_limbs::submul(limbs, length, a.limbs, a.length, b.limbs, b.length) != 0) {
+		// the product was bigger, the limbs hold the two's complement of the difference
+		for (std::size_t i = 0; i < length; i++)
+			limbs[i] = ~limbs[i];
+		limb_t one = 1;
+		bigint_limbs::add(limbs, limbs, length, &one, 1);
+		is_negative = !is_negative;
+	}
+
+	// takes care of -0
+	normalize();
+}
+
 // compares two BigInts and does not respect the sign
 // returns number > 0 if b is bigger
 // returns number < 0 if b is smaller
 // returns 0 if numbers are equals
 short BigInt::cmp_absolute(const BigInt& b) const
 {
-	if (length != b.length)
-		return length > b.length ? CMP_SECOND_PARAMETER_SMALLER : CMP_SECOND_PARAMETER_BIGGER;
-
-	for (int i = length-1; i >= 0; i--) {
-		if (digits[i] == b.digits[i])
-			continue;
-
-		return digits[i] < b.digits[i] ? CMP_SECOND_PARAMETER_BIGGER : CMP_SECOND_PARAMETER_SMALLER;
-	}
+	return bigint_limbs::cmp(limbs, length, b.limbs, b.length);
+}
 
-	return CMP_EQUAL;
+short BigInt::cmp_absolute(const BigIntView& b) const
+{
+	return bigint_limbs::cmp(limbs, length, b.get_limbs(), b.get_length());
 }
 
 // compares two BigInts
@@ -212,6 +414,8 @@ short BigInt::cmp_absolute(const BigInt& b) const
 // returns 0 if numbers are equals
 short BigInt::cmp(const BigInt& b) const
 {
+	BIGINT_STATS_SCOPE(OP_CMP, std::max(length, b.length));
+
 	// we are negative and b is not
 	if (is_negative && !b.is_negative)
 		return CMP_SECOND_PARAMETER_BIGGER;
@@ -220,23 +424,15 @@ short BigInt::cmp(const BigInt& b) const
 	if (!is_negative && b.is_negative)
 		return CMP_SECOND_PARAMETER_SMALLER;
 
-	bool all_positive = !is_negative && !b.is_negative;
-	if (all_positive) {
-		bool any_length_bigger = length != b.length;
-		if (any_length_bigger)
-			return length < b.length ? CMP_SECOND_PARAMETER_BIGGER : CMP_SECOND_PARAMETER_SMALLER;
-	}
-
-	bool all_negative = is_negative && b.is_negative;
-	if (all_negative) {
-		bool any_length_bigger = length != b.length;
-		if (any_length_bigger)
-			return length < b.length ? CMP_SECOND_PARAMETER_SMALLER : CMP_SECOND_PARAMETER_BIGGER;
-	}
-
-	return cmp_absolute(b);
+	// both have the same sign, for negative numbers the bigger absolute value is the smaller number
+	short cmp_result = cmp_absolute(b);
+	return is_negative ? -cmp_result : cmp_result;
 }
 
+short BigInt::cmp(const BigIntView& b) const
+{
+	return BigIntView(*this).cmp(b);
+}
 
 // -----------------------
 // -- Operators
@@ -244,170 +440,377 @@ short BigInt::cmp(const BigInt& b) const
 
 BigInt& BigInt::operator+=(const BigInt& b)
 {
-	bool a_negativ = is_negative;
-	bool b_negativ = b.is_negative;
+	return *this += BigIntView(b);
+}
 
-	bool both_negative = a_negativ && b_negativ;
-	bool both_positive = !a_negativ && !b_negativ;
-	bool same_sign = both_negative || both_positive;
+BigInt& BigInt::operator -= (const BigInt& b)
+{
+	return *this -= BigIntView(b);
+}
 
-	if (same_sign) {
-		// keep sign if both are the same sign and add
-		BigInt sum = add(*this, b);
-		is_negative = a_negativ;
-		length = sum.length;
+BigInt& BigInt::operator*=(const BigInt& b)
+{
+	return *this *= BigIntView(b);
+}
 
-		delete digits;
-		digits = new unsigned short[length];
-		memcpy(digits, sum.digits, sizeof(unsigned short) * length);
-	}
+BigInt& BigInt::operator+=(const BigIntView& b)
+{
+	BIGINT_STATS_SCOPE(OP_ADD, std::max(length, b.get_length()));
+	add_signed(b, b.get_is_negative());
+	return *this;
+}
 
-	bool one_negative = a_negativ != b_negativ;
-	if (one_negative) {
-		// if the signs are different, subtract the numbers and use the sign of the largest number
-		bool is_a_larger = cmp_absolute(b) == CMP_SECOND_PARAMETER_SMALLER;
-		bool sign_to_use = is_a_larger ? is_negative : b.is_negative;
-		// let's use a new BigInt so we can change the sign
-		BigInt b_copy_different_sign{ b };
-		// let's change signs to positive for the simple substract
-		b_copy_different_sign.is_negative = false;
-		is_negative = false;
-		BigInt sum = substract(
-			is_a_larger ? *this : b_copy_different_sign,
-			is_a_larger ? b_copy_different_sign : *this
-		);
-		length = sum.length;
-		// use the sign we calculated earlier and take care of -0
-		bool is_zero = sum.length == 1 && sum.digits[0] == 0;
-		is_negative = is_zero ? false : sign_to_use;
-
-		delete digits;
-		digits = new unsigned short[length];
-		memcpy(digits, sum.digits, sizeof(unsigned short) * length);
-	}
+BigInt& BigInt::operator-=(const BigIntView& b)
+{
+	BIGINT_STATS_SCOPE(OP_SUB, std::max(length, b.get_length()));
+	add_signed(b, !b.get_is_negative());
+	return *this;
+}
+
+BigInt& BigInt::operator*=(const BigIntView& b)
+{
+	BIGINT_STATS_SCOPE(OP_MUL, length + b.get_length());
+
+	// the product of two numbers never has more limbs than both together
+	BigInt product(length + b.get_length(), is_negative != b.get_is_negative(), resource);
+	bigint_limbs::mul(product.limbs, limbs, length, b.get_limbs(), b.get_length());
+
+	product.normalize();
+	*this = std::move(product);
 
 	return *this;
 }
 
-BigInt& BigInt::operator -= (const BigInt& b)
+BigInt BigInt::with_capacity(std::size_t limb_count)
 {
-	BigInt b_inverted{ b };
-	b_inverted.is_negative = !b.is_negative;
-	return *this += b_inverted;
+	BigInt result(0);
+	result.reserve(limb_count);
+	return result;
 }
 
-BigInt& BigInt::operator*=(const BigInt& b)
+BigInt& BigInt::operator+=(const Product& product)
 {
-	int current_length = length > b.length ? length : b.length;
-	unsigned short* product_digits = new unsigned short[current_length] {};
-	unsigned short current = 0;
-
-	for (int i = 0; i < b.length; i++) {
-		unsigned short carry = 0;
-		unsigned short digit = 0;
-		int j = i;
-		while (j < length + i) {
-			if (current_length < j + 1) {
-				increase_size(product_digits, current_length, current_length + 1);
-				current_length++;
-			}
-			// create current product, with carry and current digit
-			unsigned short product = product_digits[j] + (b.digits[i] * digits[j - i]) + carry;
-			// calc digit and carry
-			digit = product % 10;
-			carry = product / 10;
-			product_digits[j] = digit;
-			j++;
-		}
+	add_product(product.a, product.b, false);
+	return *this;
+}
 
+BigInt& BigInt::operator-=(const Product& product)
+{
+	add_product(product.a, product.b, true);
+	return *this;
+}
 
-		// last iterations carry
-		if (carry > 0) {
-			if (current_length < j + 1) {
-				increase_size(product_digits, current_length, current_length + 1);
-				current_length++;
-			}
-			digit = product_digits[j] + carry;
-			carry = digit / 10;
-			product_digits[j] = digit % 10;
-		}
+BigInt& BigInt::operator=(const Product& product)
+{
+	// as an operand we are read while the product is written
+	if (this == &product.a || this == &product.b) {
+		*this = BigInt(product, resource);
+		return *this;
 	}
 
-	// 4. remove leading zeros
-	// we could improve this algorithm by calculating the new size BEFORE shrinking the array
-	// so we could shrink it in one statement
-	for (int i = 1; i < current_length && current_length > 1; i++) {
-		bool leading_zero = product_digits[current_length - i] == 0;
-		if (leading_zero) {
-			decrease_size(product_digits, current_length, current_length - i);
-			current_length--;
-			i--;
-		}
-		else {
-			break;
-		}
-	}
+	BIGINT_STATS_SCOPE(OP_MUL, product.max_length());
 
-	delete digits;
-	digits = new unsigned short[current_length];
-	length = current_length;
-	bool is_zero = length == 1 && digits[0] == 0;
-	is_negative = is_zero ? false : is_negative || b.is_negative;
-	memcpy(digits, product_digits, sizeof(unsigned short) * current_length);
+	// the old value is dropped first, so growing the buffer copies nothing
+	std::size_t product_length = product.a.length + product.b.length;
+	length = 0;
+	ensure_capacity(product_length);
+	bigint_limbs::mul(limbs, product.a.limbs, product.a.length, product.b.limbs, product.b.length);
+	length = product_length;
+	is_negative = product.a.is_negative != product.b.is_negative;
+	normalize();
 
 	return *this;
 }
 
 BigInt& BigInt::operator/=(const BigInt& b)
 {
-	BigInt dividor = BigInt{ b };
-	BigInt rest = BigInt(*this);
-	BigInt quotient = 0;
+	*this = std::move(divmod(*this, b).first);
+	return *this;
+}
 
-	assert(dividor != 0);
+BigInt& BigInt::operator%=(const BigInt& b)
+{
+	*this = std::move(divmod(*this, b).second);
+	return *this;
+}
 
-	if (dividor > (*this))
-	{
-		delete digits;
-		digits = new unsigned short[1]{ 0 };
-		length = 1;
-		is_negative = false;
+BigInt& BigInt::operator/=(const BigIntView& b)
+{
+	*this = std::move(divmod(*this, b).first);
+	return *this;
+}
+
+BigInt& BigInt::operator%=(const BigIntView& b)
+{
+	*this = std::move(divmod(*this, b).second);
+	return *this;
+}
+
+BigInt& BigInt::operator<<=(std::size_t bits)
+{
+	if (length == 0 || bits == 0)
 		return *this;
-	}
 
-	if (b < 0)
-		dividor.is_negative = false;
+	// the limbs move up in place, the kernel starts at the top so nothing is overwritten before it was read
+	std::size_t limb_shift = bits / LIMB_BITS;
+	ensure_capacity(length + limb_shift + 1);
+	limbs[length + limb_shift] = bigint_limbs::shift_left(limbs + limb_shift, limbs, length, bits % LIMB_BITS);
+	std::fill(limbs, limbs + limb_shift, 0);
+	length += limb_shift + 1;
+	normalize();
+	return *this;
+}
 
-	if (rest < 0)
-		rest.is_negative = false;
+BigInt& BigInt::operator>>=(std::size_t bits)
+{
+	if (length == 0 || bits == 0)
+		return *this;
 
-	while (rest >= dividor) {
-		quotient += 1;
-		rest -= dividor;
+	// a negative number rounds down, so its magnitude grows by one if a set bit is shifted out
+	bool is_rounded_up = is_negative && trailing_zero_bits(limbs, length) < bits;
+
+	std::size_t limb_shift = bits / LIMB_BITS;
+	if (limb_shift >= length) {
+		length = 0;
+	}
+	else {
+		bigint_limbs::shift_right(limbs, limbs + limb_shift, length - limb_shift, bits % LIMB_BITS);
+		length -= limb_shift;
 	}
 
-	delete digits;
-	digits = new unsigned short[quotient.length]{};
-	length = quotient.length;
-	bool is_zero = length == 1 && digits[0] == 0;
-	is_negative = is_zero ? false : is_negative || b.is_negative;
-	memcpy(digits, quotient.digits, sizeof(unsigned short) * quotient.length);
+	if (is_rounded_up) {
+		ensure_capacity(length + 1);
+		limbs[length] = 0;
+		limb_t one = 1;
+		bigint_limbs::add(limbs, limbs, length + 1, &one, 1);
+		length++;
+	}
 
+	normalize();
 	return *this;
 }
 
+BigInt& BigInt::operator&=(const BigInt& b)
+{
+	apply_bitwise(b, BITWISE_AND);
+	return *this;
+}
+
+BigInt& BigInt::operator|=(const BigInt& b)
+{
+	apply_bitwise(b, BITWISE_OR);
+	return *this;
+}
+
+BigInt& BigInt::operator^=(const BigInt& b)
+{
+	apply_bitwise(b, BITWISE_XOR);
+	return *this;
+}
+
+void BigInt::apply_bitwise(const BigInt& b, BitwiseOperation operation)
+{
+	// x & x and x | x are x, x ^ x is zero
+	if (this == &b) {
+		if (operation == BITWISE_XOR)
+			length = 0;
+		normalize();
+		return;
+	}
+
+	std::size_t max_length = std::max(length, b.length) + 1;
+	ensure_capacity(max_length);
+	is_negative = bigint_limbs::bitwise(limbs, limbs, length, is_negative, b.limbs, b.length, b.is_negative, operation);
+	length = max_length;
+	normalize();
+}
+
+std::size_t BigInt::bit_length() const
+{
+	return bigint_limbs::bit_length(limbs, length);
+}
+
+std::size_t BigInt::popcount() const
+{
+	return bigint_limbs::popcount(limbs, length);
+}
+
+bool BigInt::test_bit(std::size_t index) const
+{
+	std::size_t limb_index = index / LIMB_BITS;
+	bool is_set = limb_index < length && ((limbs[limb_index] >> (index % LIMB_BITS)) & 1) != 0;
+	if (!is_negative)
+		return is_set;
+
+	// -m is ~(m - 1), m - 1 has the bits below the lowest set bit of m set, that bit cleared and all others unchanged
+	std::size_t lowest = trailing_zero_bits(limbs, length);
+	return index == lowest || (index > lowest && !is_set);
+}
+
+void BigInt::set_bit(std::size_t index, bool value)
+{
+	if (test_bit(index) == value)
+		return;
+
+	// flipping a bit from 0 to 1 adds 2^index in two's complement and flipping it back subtracts it,
+	// for a negative number that subtracts it from or adds it to the magnitude
+	std::size_t limb_index = index / LIMB_BITS;
+	limb_t bit = limb_t(1) << (index % LIMB_BITS);
+	if (value != is_negative) {
+		std::size_t max_length = std::max(length, limb_index + 1) + 1;
+		ensure_capacity(max_length);
+		std::fill(limbs + length, limbs + max_length, 0);
+		length = max_length;
+		bigint_limbs::add(limbs + limb_index, limbs + limb_index, length - limb_index, &bit, 1);
+	}
+	else {
+		// the bit is set in the magnitude of a positive number, and below the bit_length() of a negative one,
+		// so the magnitude stays positive
+		bigint_limbs::sub(limbs + limb_index, limbs + limb_index, length - limb_index, &bit, 1);
+	}
+
+	normalize();
+}
+
+BigInt square(const BigInt& b)
+{
+	BIGINT_STATS_SCOPE(OP_MUL, 2 * b.length);
+
+	BigInt result(2 * b.length, false, BigInt::default_resource());
+	bigint_limbs::sqr(result.limbs, b.limbs, b.length);
+	result.normalize();
+	return result;
+}
+
+BigInt pow(const BigInt& b, std::uint64_t exponent)
+{
+	BIGINT_STATS_SCOPE(OP_MUL, b.length);
+
+	// the length check throws std::length_error for results beyond MAX_LIMBS
+	BigInt result(bigint_limbs::power_length(b.limbs, b.length, exponent), b.is_negative && exponent % 2 == 1, BigInt::default_resource());
+	bigint_limbs::pow(result.limbs, b.limbs, b.length, exponent);
+	result.normalize();
+	return result;
+}
+
+BigInt power_of_ten(std::uint64_t exponent)
+{
+	BIGINT_STATS_SCOPE(OP_MUL, 1);
+
+	BigInt result(bigint_limbs::power_of_ten_length(exponent), false, BigInt::default_resource());
+	bigint_limbs::power_of_ten(result.limbs, exponent);
+	result.normalize();
+	return result;
+}
+
+std::pair<BigInt, BigInt> divmod(const BigInt& dividend, const BigInt& divisor)
+{
+	return divmod(dividend, BigIntView(divisor));
+}
+
+std::pair<BigInt, BigInt> divmod(const BigInt& dividend, const BigIntView& divisor)
+{
+	assert(divisor.get_length() != 0);
+	BIGINT_STATS_SCOPE(OP_DIV, dividend.length);
+
+	// the divisor is bigger, nothing to divide
+	if (dividend.cmp_absolute(divisor) == CMP_SECOND_PARAMETER_BIGGER)
+		return std::make_pair(BigInt(0), dividend);
+
+	// the quotient is calculated on the absolute values, the signs are applied afterwards
+	BigInt quotient(dividend.length - divisor.get_length() + 1, dividend.is_negative != divisor.get_is_negative(), dividend.resource);
+	BigInt remainder(divisor.get_length(), dividend.is_negative, dividend.resource);
+	bigint_limbs::divmod(quotient.limbs, remainder.limbs, dividend.limbs, dividend.length, divisor.get_limbs(), divisor.get_length());
+
+	quotient.normalize();
+	remainder.normalize();
+	return std::make_pair(std::move(quotient), std::move(remainder));
+}
+
 std::ostream& operator<<(std::ostream& os, const BigInt& b)
 {
+	return os << to_string(b);
+}
+
+std::string to_string(const BigInt& b)
+{
+	BIGINT_STATS_SCOPE(OP_TO_STRING, b.length);
+
 	if (b.length == 0)
-		return os << "0";
+		return "0";
+
+	limb_vector chunks = to_decimal_chunks(b.limbs, b.length);
+	std::string text(decimal_length(chunks, b.is_negative), '0');
+	write_decimal(&text[0], chunks, b.is_negative);
+	return text;
+}
+
+std::to_chars_result to_chars(char* first, char* last, const BigInt& b)
+{
+	BIGINT_STATS_SCOPE(OP_TO_STRING, b.length);
+
+	if (b.length == 0) {
+		if (first == last)
+			return { last, std::errc::value_too_large };
+		*first = '0';
+		return { first + 1, std::errc() };
+	}
+
+	limb_vector chunks = to_decimal_chunks(b.limbs, b.length);
+	std::size_t text_length = decimal_length(chunks, b.is_negative);
+	if (static_cast<std::size_t>(last - first) < text_length)
+		return { last, std::errc::value_too_large };
 
-	if (b.is_negative)
-		os << "-";
+	write_decimal(first, chunks, b.is_negative);
+	return { first + text_length, std::errc() };
+}
 
-	for (int i = 0; i < b.length; i++)
-		os << b.digits[b.length - i - 1];
+std::from_chars_result from_chars(const char* first, const char* last, BigInt& b)
+{
+	const char* digits_start = first;
+	bool is_negative = digits_start != last && *digits_start == '-';
+	if (is_negative)
+		digits_start++;
+
+	const char* digits_end = digits_start;
+	while (digits_end != last && *digits_end >= '0' && *digits_end <= '9')
+		digits_end++;
+
+	if (digits_end == digits_start)
+		return { first, std::errc::invalid_argument };
+
+	std::size_t digit_count = digits_end - digits_start;
+	BIGINT_STATS_SCOPE(OP_FROM_STRING, limbs_for_decimal_chunks((digit_count + DECIMAL_CHUNK_DIGITS - 1) / DECIMAL_CHUNK_DIGITS));
+
+	// group the digits into chunks of 9 from the end, the first chunk holds the least significant digits
+	limb_vector chunks((digit_count + DECIMAL_CHUNK_DIGITS - 1) / DECIMAL_CHUNK_DIGITS);
+	const char* chunk_end = digits_end;
+	for (std::size_t i = 0; i < chunks.size(); i++) {
+		const char* chunk_start = chunk_end - std::min<std::size_t>(DECIMAL_CHUNK_DIGITS, chunk_end - digits_start);
+		limb_t chunk = 0;
+		for (const char* digit = chunk_start; digit != chunk_end; digit++)
+			chunk = chunk * 10 + static_cast<limb_t>(*digit - '0');
+		chunks[i] = chunk;
+		chunk_end = chunk_start;
+	}
 
-	return os;
+	// the old value is not needed, so nothing is copied when the buffer grows
+	b.length = 0;
+	b.ensure_capacity(limbs_for_decimal_chunks(chunks.size()));
+	b.length = from_decimal_chunks(b.limbs, chunks.data(), chunks.size());
+	b.is_negative = is_negative;
+	b.normalize();
+
+	return { digits_end, std::errc() };
+}
+
+BigInt from_string(const std::string& text)
+{
+	BigInt value{ 0 };
+	std::from_chars_result result = from_chars(text.data(), text.data() + text.size(), value);
+	if (result.ec != std::errc() || result.ptr != text.data() + text.size())
+		throw std::invalid_argument("from_string: \"" + text + "\" is not a decimal number");
+	return value;
 }
 
 bool operator==(const BigInt& b1, const BigInt& b2)
@@ -442,21 +845,156 @@ bool operator>=(const BigInt& b1, const BigInt& b2)
 
 BigInt operator+(BigInt b1, const BigInt& b2)
 {
-	return b1 += b2;
+	// b1 is our own copy, returning it moves the result out
+	b1 += b2;
+	return b1;
 }
 
 BigInt operator-(BigInt b1, const BigInt& b2)
 {
-	return b1 -= b2;
+	b1 -= b2;
+	return b1;
+}
+
+BigInt operator+(const BigInt& b1, BigInt&& b2)
+{
+	b2 += b1;
+	return std::move(b2);
+}
+
+BigInt operator-(const BigInt& b1, BigInt&& b2)
+{
+	// b1 - b2 = -(b2 - b1)
+	b2 -= b1;
+	b2.is_negative = !b2.is_negative;
+	b2.normalize();
+	return std::move(b2);
+}
+
+BigInt::Product operator*(const BigInt& b1, const BigInt& b2)
+{
+	return BigInt::Product(b1, b2);
+}
+
+BigInt operator+(const BigInt& b1, const BigInt::Product& b2)
+{
+	BigInt sum = BigInt::with_capacity(std::max(b1.length, b2.max_length()) + 1);
+	sum += b1;
+	sum += b2;
+	return sum;
+}
+
+BigInt operator+(BigInt&& b1, const BigInt::Product& b2)
+{
+	b1 += b2;
+	return std::move(b1);
+}
+
+BigInt operator+(const BigInt::Product& b1, const BigInt& b2)
+{
+	return b2 + b1;
+}
+
+BigInt operator+(const BigInt::Product& b1, BigInt&& b2)
+{
+	b2 += b1;
+	return std::move(b2);
+}
+
+BigInt operator+(const BigInt::Product& b1, const BigInt::Product& b2)
+{
+	BigInt sum = BigInt::with_capacity(std::max(b1.max_length(), b2.max_length()) + 1);
+	sum += b1;
+	sum += b2;
+	return sum;
+}
+
+BigInt operator-(const BigInt& b1, const BigInt::Product& b2)
+{
+	BigInt difference = BigInt::with_capacity(std::max(b1.length, b2.max_length()) + 1);
+	difference += b1;
+	difference -= b2;
+	return difference;
+}
+
+BigInt operator-(BigInt&& b1, const BigInt::Product& b2)
+{
+	b1 -= b2;
+	return std::move(b1);
 }
 
-BigInt operator*(BigInt b1, const BigInt& b2)
+BigInt operator-(const BigInt::Product& b1, const BigInt& b2)
 {
-	return b1 *= b2;
+	// b1 - b2 = -b2 + b1
+	BigInt difference = BigInt::with_capacity(std::max(b2.length, b1.max_length()) + 1);
+	difference -= b2;
+	difference += b1;
+	return difference;
+}
+
+BigInt operator-(const BigInt::Product& b1, BigInt&& b2)
+{
+	b2.is_negative = !b2.is_negative;
+	b2.normalize();
+	b2 += b1;
+	return std::move(b2);
+}
+
+BigInt operator-(const BigInt::Product& b1, const BigInt::Product& b2)
+{
+	BigInt difference = BigInt::with_capacity(std::max(b1.max_length(), b2.max_length()) + 1);
+	difference += b1;
+	difference -= b2;
+	return difference;
 }
 
 BigInt operator/(BigInt b1, const BigInt& b2)
 {
-	return b1 /= b2;
+	b1 /= b2;
+	return b1;
+}
+
+BigInt operator%(BigInt b1, const BigInt& b2)
+{
+	b1 %= b2;
+	return b1;
+}
+
+BigInt operator<<(BigInt b, std::size_t bits)
+{
+	b <<= bits;
+	return b;
+}
+
+BigInt operator>>(BigInt b, std::size_t bits)
+{
+	b >>= bits;
+	return b;
+}
+
+BigInt operator&(BigInt b1, const BigInt& b2)
+{
+	b1 &= b2;
+	return b1;
 }
 
+BigInt operator|(BigInt b1, const BigInt& b2)
+{
+	b1 |= b2;
+	return b1;
+}
+
+BigInt operator^(BigInt b1, const BigInt& b2)
+{
+	b1 ^= b2;
+	return b1;
+}
+
+BigInt operator~(BigInt b)
+{
+	// -b - 1, the sign flips first and one is subtracted with the new sign, ~0 goes through -0 to -1
+	b.is_negative = !b.is_negative;
+	limb_t one = 1;
+	b.add_signed(BigIntView(&one, 1, false), true);
+	return b;
+}
@@ -1,52 +1,253 @@
 #pragma once
 
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <memory_resource>
+#include <string>
+#include <utility>
+
+class BigIntView;
+template <std::size_t N>
+class BigIntConstant;
+template <unsigned Bits>
+class FixedBigInt;
+namespace bigint_limbs
+{
+	enum BitwiseOperation : unsigned char;
+}
 
 class BigInt
 {
+	public:
+		// one limb is a "digit" in base 2^32, stored least significant limb first
+		typedef std::uint32_t limb_t;
+		// wide enough to hold the product of two limbs plus two carries
+		typedef std::uint64_t double_limb_t;
+
+		static const unsigned LIMB_BITS = 32;
+
+		// most limbs one BigInt can hold, so the sum of two lengths and the size in bytes never overflow
+		// growing beyond it throws std::length_error, a failed allocation throws std::bad_alloc
+		// in both cases the value stays unchanged
+		static constexpr std::size_t MAX_LIMBS = SIZE_MAX / 2 / sizeof(limb_t);
+
+		// operand sizes in limbs from which operator*= switches from schoolbook to karatsuba
+		// and from karatsuba to toom-3 multiplication, tune them for the target machine
+		static std::size_t karatsuba_threshold;
+		static std::size_t toom3_threshold;
+		// operand size in limbs from which squaring switches from schoolbook to karatsuba
+		// higher than karatsuba_threshold, since schoolbook squaring computes every limb product once
+		static std::size_t karatsuba_square_threshold;
+		// operand size in limbs from which the number theoretic transform is used
+		static std::size_t ntt_threshold;
+		// divisor and quotient size in limbs from which division uses newton reciprocals instead of long division
+		static std::size_t newton_division_threshold;
+		// number size in limbs from which decimal conversion splits the number by divide and conquer
+		static std::size_t conversion_threshold;
+		// operand size in limbs from which gcd halves the numbers with a recursive half gcd before the lehmer steps
+		static std::size_t half_gcd_threshold;
+
+		// threads one multiplication may use, including the calling thread
+		// 1 keeps every multiplication on the calling thread and starts no worker threads
+		static std::size_t thread_count;
+		// operand size in limbs from which the sub-products of a multiplication run in parallel
+		static std::size_t parallel_threshold;
+
+		// vector instruction sets for the basic limb loops: add, subtract, compare and multiply by one limb
+		enum SimdLevel { SIMD_PORTABLE, SIMD_AVX2, SIMD_AVX512 };
+		// highest instruction set the loops may use, the cpu features are detected at runtime and limit it further
+		// SIMD_PORTABLE forces the plain c++ loops
+		static SimdLevel simd_level;
+
+		// memory resource new BigInts and the scratch buffers of the algorithms allocate from on the calling thread
+		// defaults to std::pmr::get_default_resource()
+		static std::pmr::memory_resource* default_resource();
+
+		// replaces the memory resource of the calling thread and returns the previous one
+		// nullptr goes back to std::pmr::get_default_resource()
+		static std::pmr::memory_resource* set_default_resource(std::pmr::memory_resource* resource);
+
+		// uses a memory resource for all BigInts created by the calling thread while the scope is alive
+		// e.g. a std::pmr::monotonic_buffer_resource for one job, which releases all temporaries at once
+		// BigInts allocated from the resource must not outlive it
+		class ResourceScope
+		{
+			public:
+				explicit ResourceScope(std::pmr::memory_resource* resource) : previous(set_default_resource(resource)) {}
+				~ResourceScope() { set_default_resource(previous); }
+
+				ResourceScope(const ResourceScope&) = delete;
+				ResourceScope& operator=(const ResourceScope&) = delete;
+
+			private:
+				std::pmr::memory_resource* previous;
+		};
+
+		// lazy product returned by operator*, it is only evaluated when it becomes a BigInt
+		// a + b * c and a - b * c run as one fused multiply-add into a single result buffer,
+		// x = b * c and x += b * c write straight into the buffer of x
+		// it only refers to its operands, so it must not outlive the full expression, e.g. in an auto variable
+		class Product
+		{
+			public:
+				Product(const BigInt& a, const BigInt& b) : a(a), b(b) {}
+
+				// the product never has more limbs than both operands together
+				std::size_t max_length() const { return a.length + b.length; }
+
+				const BigInt& a;
+				const BigInt& b;
+		};
+
 	private:
 		bool is_negative;
-		unsigned long length;
-		unsigned short* digits;
+		// number of used limbs, zero is represented by length 0
+		std::size_t length;
+		// number of allocated limbs, the limbs beyond length are unused
+		std::size_t capacity;
+		// points to inline_limbs as long as the value fits, afterwards to a buffer of resource
+		limb_t* limbs;
+		// where heap buffers come from, fixed for the lifetime of the object
+		std::pmr::memory_resource* resource;
+
+		// small values are stored inside the object and never touch the heap
+		static constexpr std::size_t INLINE_LIMBS = 4;
+		limb_t inline_limbs[INLINE_LIMBS];
 
-		// get a digit value or default (0)
+		bool is_inline() const { return limbs == inline_limbs; }
+
+		// frees a heap buffer and goes back to the inline limbs, the value is lost
+		void release();
+
+		// get a limb value or default (0)
 		// util function for calculations where we could possibly go beyond our bounds
-		constexpr unsigned short get_digit_or_default(int index) const { return index >= length ? 0 : digits[index]; }
+		constexpr limb_t get_limb_or_default(std::size_t index) const { return index >= length ? 0 : limbs[index]; }
+
+		// creates a zero filled BigInt with room for length limbs
+		// used as destination by the calculation utils, call normalize() after filling it
+		BigInt(std::size_t length, bool is_negative, std::pmr::memory_resource* resource);
+
+		// removes leading zero limbs and clears the sign of zero
+		void normalize();
+
+		// makes room for at least new_capacity limbs, keeps the current value
+		// grows geometrically so repeated small growths cost amortized O(1) copies per limb
+		void ensure_capacity(std::size_t new_capacity);
+
+		// adds b with the given sign in place, shared by += and -=
+		void add_signed(const BigIntView& b, bool b_is_negative);
+
+		// replaces the value by its bitwise and, or or xor with b in place, shared by &=, |= and ^=
+		void apply_bitwise(const BigInt& b, bigint_limbs::BitwiseOperation operation);
+
+		// adds or subtracts a * b in place with one fused multiply-add, shared by the product operators
+		void add_product(const BigInt& a, const BigInt& b, bool is_subtraction);
+
+		// a zero with room for limb_count limbs, so a fused result is allocated once
+		static BigInt with_capacity(std::size_t limb_count);
 
 	public:
 		// cosntructor
-		BigInt(long int value);
-		BigInt(unsigned short* digits, unsigned short length, bool is_negative);
+		// the heap limbs come from resource, default_resource() if none is given
+		BigInt(long int value, std::pmr::memory_resource* resource = default_resource());
+		// creates a BigInt from decimal digits (least significant digit first)
+		// takes ownership of digits, the array is released after conversion, also if it throws
+		BigInt(unsigned short* digits, std::size_t length, bool is_negative, std::pmr::memory_resource* resource = default_resource());
+
+		// copies the limbs of a view
+		explicit BigInt(const BigIntView& view, std::pmr::memory_resource* resource = default_resource());
+
+		// evaluates a product, implicit so a product can be used wherever a BigInt is expected
+		BigInt(const Product& product, std::pmr::memory_resource* resource = default_resource());
 
 		// destructor
 		~BigInt();
 
-		// copy constructor
+		// copy constructor, like the std::pmr containers the copy uses default_resource() and not the one of b
 		BigInt(const BigInt& b);
+		BigInt(const BigInt& b, std::pmr::memory_resource* resource);
 
-		// assignment
+		// move constructor, b is left as zero
+		// heap buffers are taken over together with their resource, inline limbs are copied
+		BigInt(BigInt&& b) noexcept;
+
+		// assignment, keeps our resource
 		BigInt& operator=(const BigInt& b);
 
+		// move assignment, b is left as zero
+		// takes over the buffer of b if both use the same resource, copies otherwise
+		BigInt& operator=(BigInt&& b);
+
+		// evaluates the product into our buffer, keeps our resource
+		BigInt& operator=(const Product& product);
+
+		std::pmr::memory_resource* get_resource() const { return resource; }
+
+		// reserves room for at least limb_count limbs, so growing up to this size does not reallocate
+		void reserve(std::size_t limb_count);
+
+		// releases the unused limbs beyond the current length
+		void shrink_to_fit();
+
 		// compares two BigInts
 		// returns number > 0 if b is bigger
 		// returns number < 0 if b is smaller
 		// returns 0 if numbers are equals
 		short cmp(const BigInt& b) const;
+		short cmp(const BigIntView& b) const;
 
 		// compares two BigInts absolute value (sign will be ignored)
 		// returns number > 0 if b is bigger
 		// returns number < 0 if b is smaller
 		// returns 0 if numbers are equals
 		short cmp_absolute(const BigInt& b) const;
+		short cmp_absolute(const BigIntView& b) const;
 
 		BigInt& operator += (const BigInt& b);
 		BigInt& operator -= (const BigInt& b);
 		BigInt& operator *= (const BigInt& b);
 		BigInt& operator /= (const BigInt& b);
+		BigInt& operator %= (const BigInt& b);
+		BigInt& operator += (const Product& product);
+		BigInt& operator -= (const Product& product);
+		// a view as right operand is used in place, e.g. the limbs of a serialized buffer
+		BigInt& operator += (const BigIntView& b);
+		BigInt& operator -= (const BigIntView& b);
+		BigInt& operator *= (const BigIntView& b);
+		BigInt& operator /= (const BigIntView& b);
+		BigInt& operator %= (const BigIntView& b);
+
+		// bit operations see a negative number in two's complement with infinitely many leading ones,
+		// like the built in operators on signed integers, e.g. -6 & 3 == 2 and -7 >> 1 == -4
+		// all of them run in one pass over the limbs
+		BigInt& operator <<= (std::size_t bits);
+		BigInt& operator >>= (std::size_t bits);
+		BigInt& operator &= (const BigInt& b);
+		BigInt& operator |= (const BigInt& b);
+		BigInt& operator ^= (const BigInt& b);
+
+		// number of bits of the absolute value, 0 for zero
+		std::size_t bit_length() const;
+		// number of set bits of the absolute value, the two's complement of a negative number has infinitely many
+		std::size_t popcount() const;
+		// a bit of the two's complement, the bits of a negative number from bit_length() on are all set
+		bool test_bit(std::size_t index) const;
+		// sets or clears a bit of the two's complement, e.g. clearing bit 0 of -1 gives -2
+		void set_bit(std::size_t index, bool value = true);
 
 		// free insertion operator
 		friend std::ostream& operator<<(std::ostream& os, const BigInt& b);
 
+		// decimal text conversion, subquadratic for big numbers
+		friend std::string to_string(const BigInt& b);
+		// like std::to_chars and std::from_chars for integers in base 10
+		// to_chars reports std::errc::value_too_large if the buffer is too small
+		// from_chars accepts an optional '-' followed by digits and leaves b unchanged on std::errc::invalid_argument
+		friend std::to_chars_result to_chars(char* first, char* last, const BigInt& b);
+		friend std::from_chars_result from_chars(const char* first, const char* last, BigInt& b);
+
 		// free equality operators
 		friend bool operator==(const BigInt& b1, const BigInt& b2);
 		friend bool operator!=(const BigInt& b1, const BigInt& b2);
@@ -57,11 +258,73 @@ class BigInt
 
 		friend BigInt operator+(BigInt b1, const BigInt& b2);
 		friend BigInt operator-(BigInt b1, const BigInt& b2);
-		friend BigInt operator*(BigInt b1, const BigInt& b2);
+		// reuse the buffer of a temporary right operand
+		friend BigInt operator+(const BigInt& b1, BigInt&& b2);
+		friend BigInt operator-(const BigInt& b1, BigInt&& b2);
+		friend Product operator*(const BigInt& b1, const BigInt& b2);
+		// fused multiply-add, the result buffer is sized once, a temporary left operand gives its buffer
+		friend BigInt operator+(const BigInt& b1, const Product& b2);
+		friend BigInt operator+(BigInt&& b1, const Product& b2);
+		friend BigInt operator+(const Product& b1, const BigInt& b2);
+		friend BigInt operator+(const Product& b1, BigInt&& b2);
+		friend BigInt operator+(const Product& b1, const Product& b2);
+		friend BigInt operator-(const BigInt& b1, const Product& b2);
+		friend BigInt operator-(BigInt&& b1, const Product& b2);
+		friend BigInt operator-(const Product& b1, const BigInt& b2);
+		friend BigInt operator-(const Product& b1, BigInt&& b2);
+		friend BigInt operator-(const Product& b1, const Product& b2);
 		friend BigInt operator/(BigInt b1, const BigInt& b2);
+		friend BigInt operator%(BigInt b1, const BigInt& b2);
+		friend BigInt operator<<(BigInt b, std::size_t bits);
+		friend BigInt operator>>(BigInt b, std::size_t bits);
+		friend BigInt operator&(BigInt b1, const BigInt& b2);
+		friend BigInt operator|(BigInt b1, const BigInt& b2);
+		friend BigInt operator^(BigInt b1, const BigInt& b2);
+		// -b - 1
+		friend BigInt operator~(BigInt b);
+
+		// divides dividend by divisor and returns quotient and remainder of one division
+		// the quotient is truncated towards zero and the remainder has the sign of the dividend
+		friend std::pair<BigInt, BigInt> divmod(const BigInt& dividend, const BigInt& divisor);
+		friend std::pair<BigInt, BigInt> divmod(const BigInt& dividend, const BigIntView& divisor);
+
+		// b * b, computes every cross product of the limbs once, so it takes about half the time of a product
+		// x * x and x *= x notice the shared operand and take the same path
+		friend BigInt square(const BigInt& b);
+
+		// b^exponent by squaring with a sliding window over the bits of the exponent, pow(b, 0) is 1
+		// the factors of two of b are shifted in at the end, so powers of two cost no multiplication at all
+		friend BigInt pow(const BigInt& b, std::uint64_t exponent);
+		// writes its limbs in place, declared below
+		friend BigInt power_of_ten(std::uint64_t exponent);
 
 		// friendly utils for calculations
+		// both work on the absolute values and return a positive result
 		friend BigInt add(const BigInt& b1, const BigInt& b2);
+		// b1 has to be the absolute bigger value
 		friend BigInt substract(const BigInt& b1, const BigInt& b2);
+
+		// views our limbs, deserialize writes them
+		friend class BigIntView;
+		friend std::size_t deserialize(const unsigned char* data, std::size_t size, BigInt& b);
+
+		// stores the limbs of many BigInts in one pool
+		friend class BigIntBatch;
+		// works on the limbs of the modulus and the operands
+		friend class BigIntModContext;
+		// copies its compile time limbs into a new BigInt
+		template <std::size_t N>
+		friend class BigIntConstant;
+		// converts from and to its inline limbs
+		template <unsigned Bits>
+		friend class FixedBigInt;
 };
 
+// parses a decimal number, throws std::invalid_argument unless the whole text is one
+// from_chars parses without exceptions and stops at the first character that is not a digit
+BigInt from_string(const std::string& text);
+
+// 10^exponent, small exponents are copied from a cache and bigger ones are built from the powers the decimal conversion keeps
+// pow of 10, 100, ..., 10^9 takes the same path, the caches are shared by all threads
+BigInt power_of_ten(std::uint64_t exponent);
+
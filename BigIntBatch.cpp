@@ -0,0 +1,361 @@
+#include "BigIntBatch.h"
+#include "BigIntLimbs.h"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+#include <utility>
+
+using namespace bigint_limbs;
+
+// -----------------------
+// -- Internal Util functions
+// -----------------------
+
+// number of tasks for a bulk operation on count values with limb_count limbs together
+static std::size_t range_count(std::size_t count, std::size_t limb_count)
+{
+	return count >= 2 && use_parallel(limb_count) ? std::min(count, BigInt::thread_count) : 1;
+}
+
+// splits the indices [0, count) into ranges ranges and calls operation(range, begin, end) for every one
+// the ranges run in parallel if there is more than one
+template <typename Operation>
+static void for_ranges(std::size_t count, std::size_t ranges, Operation operation)
+{
+	if (ranges == 1) {
+		operation(0, 0, count);
+		return;
+	}
+
+	TaskGroup group;
+	for (std::size_t range = 0; range < ranges; range++) {
+		std::size_t begin = count * range / ranges;
+		std::size_t end = count * (range + 1) / ranges;
+		group.run([=, &operation] { operation(range, begin, end); });
+	}
+	group.wait();
+}
+
+// compares two signed limb arrays without leading zeros, zero is never negative
+static short cmp_signed(const limb_t* a, std::size_t a_length, bool a_is_negative, const limb_t* b, std::size_t b_length, bool b_is_negative)
+{
+	if (a_is_negative != b_is_negative)
+		return a_is_negative ? CMP_SECOND_PARAMETER_BIGGER : CMP_SECOND_PARAMETER_SMALLER;
+
+	// for negative numbers the bigger absolute value is the smaller number
+	short cmp_result = cmp(a, a_length, b, b_length);
+	return a_is_negative ? -cmp_result : cmp_result;
+}
+
+// destination = a + b for signed limb arrays without leading zeros
+// destination needs max(a_length, b_length) + 1 limbs, returns the length of the result and sets its sign
+static std::size_t add_signed(limb_t* destination, bool& is_negative, const limb_t* a, std::size_t a_length, bool a_is_negative, const limb_t* b, std::size_t b_length, bool b_is_negative)
+{
+	if (a_length < b_length) {
+		std::swap(a, b);
+		std::swap(a_length, b_length);
+		std::swap(a_is_negative, b_is_negative);
+	}
+
+	if (a_is_negative == b_is_negative) {
+		destination[a_length] = add(destination, a, a_length, b, b_length);
+		is_negative = a_is_negative;
+		return trimmed_length(destination, a_length + 1);
+	}
+
+	// different signs, subtract the smaller absolute value and use the sign of the larger one
+	// a is at least as long as b, so if b is larger both have the same length
+	if (cmp(a, a_length, b, b_length) != CMP_SECOND_PARAMETER_BIGGER) {
+		sub(destination, a, a_length, b, b_length);
+		is_negative = a_is_negative;
+	}
+	else {
+		sub(destination, b, b_length, a, a_length);
+		is_negative = b_is_negative;
+	}
+
+	std::size_t length = trimmed_length(destination, a_length);
+	is_negative = is_negative && length > 0;
+	return length;
+}
+
+// destination = a * b for signed limb arrays, destination needs a_length + b_length limbs
+// returns the length of the result and sets its sign
+static std::size_t mul_signed(limb_t* destination, bool& is_negative, const limb_t* a, std::size_t a_length, bool a_is_negative, const limb_t* b, std::size_t b_length, bool b_is_negative)
+{
+	mul(destination, a, a_length, b, b_length);
+	std::size_t length = trimmed_length(destination, a_length + b_length);
+	is_negative = length > 0 && a_is_negative != b_is_negative;
+	return length;
+}
+
+// -----------------------
+// -- Constructors
+// -----------------------
+
+BigIntBatch::BigIntBatch(std::pmr::memory_resource* resource) : limbs(resource), offsets(resource), lengths(resource), signs(resource)
+{
+}
+
+BigIntBatch::BigIntBatch(const std::vector<BigInt>& values, std::pmr::memory_resource* resource) : BigIntBatch(resource)
+{
+	std::size_t limb_count = 0;
+	for (const BigInt& value : values)
+		limb_count += value.length;
+
+	reserve(values.size(), limb_count);
+	for (const BigInt& value : values)
+		push_back(value);
+}
+
+BigIntBatch::BigIntBatch(const BigIntBatch& b) : BigIntBatch(b, BigInt::default_resource())
+{
+}
+
+BigIntBatch::BigIntBatch(const BigIntBatch& b, std::pmr::memory_resource* resource) : limbs(b.limbs, resource), offsets(b.offsets, resource), lengths(b.lengths, resource), signs(b.signs, resource)
+{
+}
+
+// -----------------------
+// -- Storage
+// -----------------------
+
+void BigIntBatch::reserve(std::size_t count, std::size_t limb_count)
+{
+	limbs.reserve(limb_count);
+	offsets.reserve(count);
+	lengths.reserve(count);
+	signs.reserve(count);
+}
+
+void BigIntBatch::clear()
+{
+	limbs.clear();
+	offsets.clear();
+	lengths.clear();
+	signs.clear();
+}
+
+void BigIntBatch::push_back(const BigInt& value)
+{
+	offsets.push_back(limbs.size());
+	lengths.push_back(value.length);
+	signs.push_back(value.is_negative);
+	limbs.insert(limbs.end(), value.limbs, value.limbs + value.length);
+}
+
+BigInt BigIntBatch::operator[](std::size_t index) const
+{
+	assert(index < size());
+
+	const limb_t* value = limbs.data() + offsets[index];
+	BigInt result(lengths[index], signs[index] != 0, BigInt::default_resource());
+	std::copy(value, value + lengths[index], result.limbs);
+	return result;
+}
+
+std::vector<BigInt> BigIntBatch::to_vector() const
+{
+	std::vector<BigInt> values;
+	values.reserve(size());
+	for (std::size_t i = 0; i < size(); i++)
+		values.push_back((*this)[i]);
+
+	return values;
+}
+
+void BigIntBatch::fill(std::size_t count, const std::function<std::size_t(std::size_t)>& max_length, const std::function<std::size_t(std::size_t, limb_t*, bool&)>& compute)
+{
+	assert(empty());
+
+	// the pool is laid out before, so every value can be computed on its own
+	// values shorter than their room leave a small gap in the pool
+	offsets.resize(count);
+	lengths.resize(count);
+	signs.resize(count);
+	std::size_t limb_count = 0;
+	for (std::size_t i = 0; i < count; i++) {
+		offsets[i] = limb_count;
+		limb_count += max_length(i);
+	}
+	limbs.resize(limb_count);
+
+	for_ranges(count, range_count(count, limb_count), [&](std::size_t, std::size_t begin, std::size_t end) {
+		for (std::size_t i = begin; i < end; i++) {
+			bool is_negative = false;
+			lengths[i] = compute(i, limbs.data() + offsets[i], is_negative);
+			signs[i] = is_negative;
+		}
+	});
+}
+
+BigIntBatch::Operand BigIntBatch::operand(std::size_t index) const
+{
+	return Operand{ limbs.data() + offsets[index], lengths[index], signs[index] != 0 };
+}
+
+BigIntBatch::Operand BigIntBatch::operand(const BigInt& value)
+{
+	return Operand{ value.limbs, value.length, value.is_negative };
+}
+
+// -----------------------
+// -- Bulk operations
+// -----------------------
+
+short BigIntBatch::cmp(std::size_t index, const BigIntBatch& b, std::size_t b_index) const
+{
+	assert(index < size() && b_index < b.size());
+
+	Operand value = operand(index);
+	Operand b_value = b.operand(b_index);
+	return cmp_signed(value.limbs, value.length, value.is_negative, b_value.limbs, b_value.length, b_value.is_negative);
+}
+
+std::vector<short> BigIntBatch::cmp(const BigIntBatch& b) const
+{
+	assert(size() == b.size());
+
+	std::vector<short> results(size());
+	for_ranges(size(), range_count(size(), limbs.size()), [&](std::size_t, std::size_t begin, std::size_t end) {
+		for (std::size_t i = begin; i < end; i++)
+			results[i] = cmp(i, b, i);
+	});
+
+	return results;
+}
+
+BigInt BigIntBatch::sum() const
+{
+	std::size_t max_length = 0;
+	for (std::size_t length : lengths)
+		max_length = std::max(max_length, length);
+
+	// the positive and the negative values are summed up separately and subtracted at the end
+	// two more limbs hold the carries of up to 2^64 values
+	std::size_t sum_length = max_length + 2;
+	std::size_t ranges = range_count(size(), limbs.size());
+	limb_vector partial_sums(2 * ranges * sum_length, 0);
+	for_ranges(size(), ranges, [&](std::size_t range, std::size_t begin, std::size_t end) {
+		limb_t* positive = partial_sums.data() + 2 * range * sum_length;
+		limb_t* negative = positive + sum_length;
+		for (std::size_t i = begin; i < end; i++) {
+			limb_t* destination = signs[i] != 0 ? negative : positive;
+			add(destination, destination, sum_length, limbs.data() + offsets[i], lengths[i]);
+		}
+	});
+
+	limb_t* positive = partial_sums.data();
+	limb_t* negative = positive + sum_length;
+	for (std::size_t range = 1; range < ranges; range++) {
+		const limb_t* partial = partial_sums.data() + 2 * range * sum_length;
+		add(positive, positive, sum_length, partial, sum_length);
+		add(negative, negative, sum_length, partial + sum_length, sum_length);
+	}
+
+	bool is_negative = bigint_limbs::cmp(positive, sum_length, negative, sum_length) == CMP_SECOND_PARAMETER_BIGGER;
+	BigInt result(sum_length, is_negative, BigInt::default_resource());
+	if (is_negative)
+		sub(result.limbs, negative, sum_length, positive, sum_length);
+	else
+		sub(result.limbs, positive, sum_length, negative, sum_length);
+
+	result.normalize();
+	return result;
+}
+
+void BigIntBatch::sort()
+{
+	std::vector<std::size_t> order(size());
+	std::iota(order.begin(), order.end(), 0);
+	auto is_less = [this](std::size_t a, std::size_t b) { return cmp(a, *this, b) == CMP_SECOND_PARAMETER_BIGGER; };
+
+	// in parallel every range is sorted on its own and the sorted ranges are merged afterwards
+	std::size_t ranges = range_count(size(), limbs.size());
+	for_ranges(size(), ranges, [&](std::size_t, std::size_t begin, std::size_t end) {
+		std::sort(order.begin() + begin, order.begin() + end, is_less);
+	});
+	for (std::size_t range = 1; range < ranges; range++) {
+		std::size_t middle = size() * range / ranges;
+		std::size_t end = size() * (range + 1) / ranges;
+		std::inplace_merge(order.begin(), order.begin() + middle, order.begin() + end, is_less);
+	}
+
+	std::pmr::vector<std::size_t> sorted_offsets(size(), offsets.get_allocator());
+	std::pmr::vector<std::size_t> sorted_lengths(size(), lengths.get_allocator());
+	std::pmr::vector<unsigned char> sorted_signs(size(), signs.get_allocator());
+	for (std::size_t i = 0; i < size(); i++) {
+		sorted_offsets[i] = offsets[order[i]];
+		sorted_lengths[i] = lengths[order[i]];
+		sorted_signs[i] = signs[order[i]];
+	}
+
+	offsets.swap(sorted_offsets);
+	lengths.swap(sorted_lengths);
+	signs.swap(sorted_signs);
+}
+
+BigIntBatch operator+(const BigIntBatch& a, const BigIntBatch& b)
+{
+	assert(a.size() == b.size());
+
+	BigIntBatch result(a.get_resource());
+	result.fill(a.size(),
+		[&](std::size_t i) { return std::max(a.lengths[i], b.lengths[i]) + 1; },
+		[&](std::size_t i, BigInt::limb_t* destination, bool& is_negative) {
+			BigIntBatch::Operand a_value = a.operand(i);
+			BigIntBatch::Operand b_value = b.operand(i);
+			return add_signed(destination, is_negative, a_value.limbs, a_value.length, a_value.is_negative, b_value.limbs, b_value.length, b_value.is_negative);
+		});
+
+	return result;
+}
+
+BigIntBatch operator-(const BigIntBatch& a, const BigIntBatch& b)
+{
+	assert(a.size() == b.size());
+
+	// a - b = a + (-b), zero stays positive
+	BigIntBatch result(a.get_resource());
+	result.fill(a.size(),
+		[&](std::size_t i) { return std::max(a.lengths[i], b.lengths[i]) + 1; },
+		[&](std::size_t i, BigInt::limb_t* destination, bool& is_negative) {
+			BigIntBatch::Operand a_value = a.operand(i);
+			BigIntBatch::Operand b_value = b.operand(i);
+			bool b_is_negative = !b_value.is_negative && b_value.length > 0;
+			return add_signed(destination, is_negative, a_value.limbs, a_value.length, a_value.is_negative, b_value.limbs, b_value.length, b_is_negative);
+		});
+
+	return result;
+}
+
+BigIntBatch operator*(const BigIntBatch& a, const BigIntBatch& b)
+{
+	assert(a.size() == b.size());
+
+	BigIntBatch result(a.get_resource());
+	result.fill(a.size(),
+		[&](std::size_t i) { return a.lengths[i] + b.lengths[i]; },
+		[&](std::size_t i, BigInt::limb_t* destination, bool& is_negative) {
+			BigIntBatch::Operand a_value = a.operand(i);
+			BigIntBatch::Operand b_value = b.operand(i);
+			return mul_signed(destination, is_negative, a_value.limbs, a_value.length, a_value.is_negative, b_value.limbs, b_value.length, b_value.is_negative);
+		});
+
+	return result;
+}
+
+BigIntBatch operator*(const BigIntBatch& a, const BigInt& factor)
+{
+	BigIntBatch::Operand factor_value = BigIntBatch::operand(factor);
+	BigIntBatch result(a.get_resource());
+	result.fill(a.size(),
+		[&](std::size_t i) { return a.lengths[i] + factor_value.length; },
+		[&](std::size_t i, BigInt::limb_t* destination, bool& is_negative) {
+			BigIntBatch::Operand a_value = a.operand(i);
+			return mul_signed(destination, is_negative, a_value.limbs, a_value.length, a_value.is_negative, factor_value.limbs, factor_value.length, factor_value.is_negative);
+		});
+
+	return result;
+}
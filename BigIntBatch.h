@@ -0,0 +1,88 @@
+#pragma once
+
+#include "BigInt.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <vector>
+
+// many BigInts in one contiguous limb pool, a value is found by its offset and length in the index
+// the index is kept as separate arrays, so bulk operations walk plain arrays instead of single heap objects
+// the stored values cannot be changed, the operations create new batches
+// bulk operations run on BigInt::thread_count threads once the batch has BigInt::parallel_threshold limbs
+class BigIntBatch
+{
+	public:
+		typedef BigInt::limb_t limb_t;
+
+		explicit BigIntBatch(std::pmr::memory_resource* resource = BigInt::default_resource());
+		explicit BigIntBatch(const std::vector<BigInt>& values, std::pmr::memory_resource* resource = BigInt::default_resource());
+
+		// like BigInt the copy uses default_resource() and not the one of b
+		BigIntBatch(const BigIntBatch& b);
+		BigIntBatch(const BigIntBatch& b, std::pmr::memory_resource* resource);
+		BigIntBatch(BigIntBatch&& b) = default;
+
+		// keeps our resource
+		BigIntBatch& operator=(const BigIntBatch& b) = default;
+		BigIntBatch& operator=(BigIntBatch&& b) = default;
+
+		std::pmr::memory_resource* get_resource() const { return limbs.get_allocator().resource(); }
+
+		std::size_t size() const { return lengths.size(); }
+		bool empty() const { return lengths.empty(); }
+
+		// reserves room for count values with limb_count limbs together
+		void reserve(std::size_t count, std::size_t limb_count);
+		void clear();
+		void push_back(const BigInt& value);
+
+		// copies values out of the batch
+		BigInt operator[](std::size_t index) const;
+		std::vector<BigInt> to_vector() const;
+
+		// compares the value at index with the value at b_index of b
+		// returns number > 0 if b is bigger
+		// returns number < 0 if b is smaller
+		// returns 0 if numbers are equals
+		short cmp(std::size_t index, const BigIntBatch& b, std::size_t b_index) const;
+
+		// compares all values with the values of b at the same index, b needs the same size
+		std::vector<short> cmp(const BigIntBatch& b) const;
+
+		// sum of all values
+		BigInt sum() const;
+
+		// sorts ascending, only the index is reordered, the limbs stay where they are
+		void sort();
+
+		// element-wise, both batches need the same size
+		friend BigIntBatch operator+(const BigIntBatch& a, const BigIntBatch& b);
+		friend BigIntBatch operator-(const BigIntBatch& a, const BigIntBatch& b);
+		friend BigIntBatch operator*(const BigIntBatch& a, const BigIntBatch& b);
+		// multiplies every value with factor
+		friend BigIntBatch operator*(const BigIntBatch& a, const BigInt& factor);
+
+	private:
+		std::pmr::vector<limb_t> limbs;
+		std::pmr::vector<std::size_t> offsets;
+		std::pmr::vector<std::size_t> lengths;
+		// one byte per sign instead of std::vector<bool>, so threads can write neighbouring signs
+		std::pmr::vector<unsigned char> signs;
+
+		// one value as raw limbs without leading zeros
+		struct Operand
+		{
+			const limb_t* limbs;
+			std::size_t length;
+			bool is_negative;
+		};
+
+		Operand operand(std::size_t index) const;
+		static Operand operand(const BigInt& value);
+
+		// fills an empty batch with count values
+		// value i gets max_length(i) limbs in the pool, compute(i, destination, is_negative) writes it and returns its length
+		void fill(std::size_t count, const std::function<std::size_t(std::size_t)>& max_length, const std::function<std::size_t(std::size_t, limb_t*, bool&)>& compute);
+};
@@ -0,0 +1,138 @@
+#include "BigIntLimbs.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace bigint_limbs
+{
+	// -----------------------
+	// -- Internal Util functions
+	// -----------------------
+
+	// counts the bits in parallel within the limb, compilers turn this into a popcnt instruction where there is one
+	static unsigned limb_popcount(limb_t limb)
+	{
+		limb = limb - ((limb >> 1) & 0x55555555);
+		limb = (limb & 0x33333333) + ((limb >> 2) & 0x33333333);
+		limb = (limb + (limb >> 4)) & 0x0F0F0F0F;
+		return (limb * 0x01010101) >> 24;
+	}
+
+	// -----------------------
+	// -- Bits
+	// -----------------------
+
+	std::size_t bit_length(const limb_t* a, std::size_t length)
+	{
+		length = trimmed_length(a, length);
+		if (length == 0)
+			return 0;
+
+		std::size_t bits = (length - 1) * BigInt::LIMB_BITS;
+		for (limb_t top = a[length - 1]; top != 0; top >>= 1)
+			bits++;
+		return bits;
+	}
+
+	std::size_t trailing_zero_bits(const limb_t* a, std::size_t length)
+	{
+		std::size_t index = 0;
+		while (a[index] == 0)
+			index++;
+		assert(index < length);
+		(void)length;
+
+		std::size_t bits = index * BigInt::LIMB_BITS;
+		for (limb_t low = a[index]; (low & 1) == 0; low >>= 1)
+			bits++;
+		return bits;
+	}
+
+	std::size_t popcount(const limb_t* a, std::size_t length)
+	{
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < length; i++)
+			count += limb_popcount(a[i]);
+		return count;
+	}
+
+	limb_t shift_left(limb_t* destination, const limb_t* a, std::size_t length, unsigned shift)
+	{
+		assert(shift < BigInt::LIMB_BITS);
+		if (length == 0)
+			return 0;
+
+		if (shift == 0) {
+			memmove(destination, a, sizeof(limb_t) * length);
+			return 0;
+		}
+
+		// from the top down, so a destination above a only overwrites limbs which were already read
+		limb_t shifted_out = a[length - 1] >> (BigInt::LIMB_BITS - shift);
+		for (std::size_t i = length - 1; i > 0; i--)
+			destination[i] = (a[i] << shift) | (a[i - 1] >> (BigInt::LIMB_BITS - shift));
+		destination[0] = a[0] << shift;
+		return shifted_out;
+	}
+
+	void shift_right(limb_t* destination, const limb_t* a, std::size_t length, unsigned shift)
+	{
+		assert(shift < BigInt::LIMB_BITS);
+		if (length == 0)
+			return;
+
+		if (shift == 0) {
+			memmove(destination, a, sizeof(limb_t) * length);
+			return;
+		}
+
+		for (std::size_t i = 0; i + 1 < length; i++)
+			destination[i] = (a[i] >> shift) | (a[i + 1] << (BigInt::LIMB_BITS - shift));
+		destination[length - 1] = a[length - 1] >> shift;
+	}
+
+	bool bitwise(limb_t* destination, const limb_t* a, std::size_t a_length, bool a_is_negative, const limb_t* b, std::size_t b_length, bool b_is_negative, BitwiseOperation operation)
+	{
+		bool is_negative;
+		switch (operation) {
+			case BITWISE_AND: is_negative = a_is_negative && b_is_negative; break;
+			case BITWISE_OR: is_negative = a_is_negative || b_is_negative; break;
+			default: is_negative = a_is_negative != b_is_negative; break;
+		}
+
+		// a negative operand -m is ~(m - 1) in two's complement, the borrow of m - 1 runs along with the limbs
+		// above its length that is ~0, the infinite leading ones of a negative number
+		// a negative result r is turned back into its magnitude ~r + 1 the same way
+		limb_t a_borrow = a_is_negative;
+		limb_t b_borrow = b_is_negative;
+		limb_t carry = is_negative;
+		limb_t a_mask = a_is_negative ? ~limb_t(0) : 0;
+		limb_t b_mask = b_is_negative ? ~limb_t(0) : 0;
+		limb_t result_mask = is_negative ? ~limb_t(0) : 0;
+
+		std::size_t length = std::max(a_length, b_length);
+		for (std::size_t i = 0; i <= length; i++) {
+			limb_t a_limb = i < a_length ? a[i] : 0;
+			limb_t x = (a_limb - a_borrow) ^ a_mask;
+			a_borrow = a_limb < a_borrow;
+
+			limb_t b_limb = i < b_length ? b[i] : 0;
+			limb_t y = (b_limb - b_borrow) ^ b_mask;
+			b_borrow = b_limb < b_borrow;
+
+			limb_t result;
+			switch (operation) {
+				case BITWISE_AND: result = x & y; break;
+				case BITWISE_OR: result = x | y; break;
+				default: result = x ^ y; break;
+			}
+
+			result = (result ^ result_mask) + carry;
+			carry = result < carry;
+			destination[i] = result;
+		}
+
+		return is_negative;
+	}
+}
@@ -0,0 +1,256 @@
+#pragma once
+
+#include "BigInt.h"
+
+#include <cassert>
+#include <cstddef>
+#include <ostream>
+
+// a number of at most N limbs in fixed storage, which can be created, computed and compared at compile time
+// results grow with the operands: a + b and a - b get one limb more than the longer operand, a * b the sum of both
+// it converts to a BigInt at runtime by copying the limbs, without parsing or computing anything
+template <std::size_t N>
+class BigIntConstant
+{
+	public:
+		typedef BigInt::limb_t limb_t;
+		typedef BigInt::double_limb_t double_limb_t;
+
+		constexpr BigIntConstant() : limbs{}, length(0), is_negative(false) {}
+
+		constexpr BigIntConstant(long long value) : limbs{}, length(0), is_negative(value < 0)
+		{
+			// the magnitude of the smallest long long does not fit into a long long
+			unsigned long long magnitude = value < 0 ? 0 - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+			for (; magnitude > 0; magnitude >>= BigInt::LIMB_BITS) {
+				assert(length < N);
+				limbs[length++] = static_cast<limb_t>(magnitude);
+			}
+		}
+
+		// copies a constant of another size, the value has to fit into N limbs
+		template <std::size_t M>
+		constexpr BigIntConstant(const BigIntConstant<M>& b) : limbs{}, length(b.length), is_negative(b.is_negative)
+		{
+			assert(b.length <= N);
+			for (std::size_t i = 0; i < b.length; i++)
+				limbs[i] = b.limbs[i];
+		}
+
+		constexpr std::size_t get_length() const { return length; }
+		constexpr bool get_is_negative() const { return is_negative; }
+		constexpr limb_t get_limb_or_default(std::size_t index) const { return index >= length ? 0 : limbs[index]; }
+
+		// compares two constants
+		// returns number > 0 if b is bigger
+		// returns number < 0 if b is smaller
+		// returns 0 if numbers are equals
+		template <std::size_t M>
+		constexpr short cmp(const BigIntConstant<M>& b) const
+		{
+			if (is_negative != b.is_negative)
+				return is_negative ? 1 : -1;
+
+			// for negative numbers the bigger absolute value is the smaller number
+			short cmp_result = cmp_absolute(b);
+			return is_negative ? -cmp_result : cmp_result;
+		}
+
+		// compares the absolute values, same result as cmp
+		template <std::size_t M>
+		constexpr short cmp_absolute(const BigIntConstant<M>& b) const
+		{
+			if (length != b.length)
+				return length > b.length ? -1 : 1;
+
+			for (std::size_t i = length; i-- > 0;) {
+				if (limbs[i] != b.limbs[i])
+					return limbs[i] < b.limbs[i] ? 1 : -1;
+			}
+
+			return 0;
+		}
+
+		template <std::size_t M> constexpr bool operator==(const BigIntConstant<M>& b) const { return cmp(b) == 0; }
+		template <std::size_t M> constexpr bool operator!=(const BigIntConstant<M>& b) const { return cmp(b) != 0; }
+		template <std::size_t M> constexpr bool operator<(const BigIntConstant<M>& b) const { return cmp(b) > 0; }
+		template <std::size_t M> constexpr bool operator>(const BigIntConstant<M>& b) const { return cmp(b) < 0; }
+		template <std::size_t M> constexpr bool operator<=(const BigIntConstant<M>& b) const { return cmp(b) >= 0; }
+		template <std::size_t M> constexpr bool operator>=(const BigIntConstant<M>& b) const { return cmp(b) <= 0; }
+
+		constexpr BigIntConstant operator-() const
+		{
+			BigIntConstant result = *this;
+			result.is_negative = length > 0 && !is_negative;
+			return result;
+		}
+
+		template <std::size_t M>
+		constexpr BigIntConstant<(N > M ? N : M) + 1> operator+(const BigIntConstant<M>& b) const
+		{
+			BigIntConstant<(N > M ? N : M) + 1> sum;
+			sum.assign_sum(*this, b, b.is_negative);
+			return sum;
+		}
+
+		template <std::size_t M>
+		constexpr BigIntConstant<(N > M ? N : M) + 1> operator-(const BigIntConstant<M>& b) const
+		{
+			BigIntConstant<(N > M ? N : M) + 1> difference;
+			difference.assign_sum(*this, b, b.length > 0 && !b.is_negative);
+			return difference;
+		}
+
+		// schoolbook multiplication, compile time constants are small
+		template <std::size_t M>
+		constexpr BigIntConstant<N + M> operator*(const BigIntConstant<M>& b) const
+		{
+			BigIntConstant<N + M> product;
+			for (std::size_t i = 0; i < b.length; i++) {
+				double_limb_t carry = 0;
+				for (std::size_t j = 0; j < length; j++) {
+					double_limb_t current = static_cast<double_limb_t>(b.limbs[i]) * limbs[j] + product.limbs[i + j] + carry;
+					product.limbs[i + j] = static_cast<limb_t>(current);
+					carry = current >> BigInt::LIMB_BITS;
+				}
+				product.limbs[i + length] = static_cast<limb_t>(carry);
+			}
+
+			product.length = length + b.length;
+			product.is_negative = is_negative != b.is_negative;
+			product.normalize();
+			return product;
+		}
+
+		// multiplies in place with factor and adds addend, the result has to fit into N limbs
+		constexpr void mul_add_small(limb_t factor, limb_t addend)
+		{
+			double_limb_t carry = addend;
+			for (std::size_t i = 0; i < length; i++) {
+				double_limb_t current = static_cast<double_limb_t>(limbs[i]) * factor + carry;
+				limbs[i] = static_cast<limb_t>(current);
+				carry = current >> BigInt::LIMB_BITS;
+			}
+
+			if (carry > 0) {
+				assert(length < N);
+				limbs[length++] = static_cast<limb_t>(carry);
+			}
+		}
+
+		// copies the limbs into a new BigInt
+		operator BigInt() const
+		{
+			BigInt result(length, is_negative, BigInt::default_resource());
+			for (std::size_t i = 0; i < length; i++)
+				result.limbs[i] = limbs[i];
+			return result;
+		}
+
+		friend std::ostream& operator<<(std::ostream& os, const BigIntConstant& b)
+		{
+			return os << BigInt(b);
+		}
+
+	private:
+		// least significant limb first like BigInt, zero has length 0
+		limb_t limbs[N];
+		std::size_t length;
+		bool is_negative;
+
+		template <std::size_t M>
+		friend class BigIntConstant;
+
+		// removes leading zero limbs and clears the sign of zero
+		constexpr void normalize()
+		{
+			while (length > 0 && limbs[length - 1] == 0)
+				length--;
+			if (length == 0)
+				is_negative = false;
+		}
+
+		// *this = a + b where b counts with the sign b_is_negative, N has to exceed the length of both
+		template <std::size_t A, std::size_t B>
+		constexpr void assign_sum(const BigIntConstant<A>& a, const BigIntConstant<B>& b, bool b_is_negative)
+		{
+			std::size_t max_length = a.length > b.length ? a.length : b.length;
+			assert(max_length < N);
+
+			// one operand is zero or both have the same sign, add the absolute values
+			if (a.is_negative == b_is_negative || b.length == 0 || a.length == 0) {
+				double_limb_t carry = 0;
+				for (std::size_t i = 0; i < max_length; i++) {
+					double_limb_t current = static_cast<double_limb_t>(a.get_limb_or_default(i)) + b.get_limb_or_default(i) + carry;
+					limbs[i] = static_cast<limb_t>(current);
+					carry = current >> BigInt::LIMB_BITS;
+				}
+				limbs[max_length] = static_cast<limb_t>(carry);
+				length = max_length + 1;
+				is_negative = a.length == 0 ? b_is_negative : a.is_negative;
+				normalize();
+				return;
+			}
+
+			// different signs, subtract the smaller absolute value and use the sign of the larger one
+			bool is_a_larger = a.cmp_absolute(b) <= 0;
+			limb_t borrow = 0;
+			for (std::size_t i = 0; i < max_length; i++) {
+				double_limb_t minuend = is_a_larger ? a.get_limb_or_default(i) : b.get_limb_or_default(i);
+				double_limb_t subtrahend = static_cast<double_limb_t>(is_a_larger ? b.get_limb_or_default(i) : a.get_limb_or_default(i)) + borrow;
+				borrow = minuend < subtrahend;
+				limbs[i] = static_cast<limb_t>(minuend - subtrahend);
+			}
+			length = max_length;
+			is_negative = is_a_larger ? a.is_negative : b_is_negative;
+			normalize();
+		}
+};
+
+// -----------------------
+// -- Literal
+// -----------------------
+
+// value of a digit character up to base 16, 16 for anything else
+constexpr BigInt::limb_t big_literal_digit(char character)
+{
+	return character >= '0' && character <= '9' ? character - '0'
+		: character >= 'a' && character <= 'f' ? character - 'a' + 10
+		: character >= 'A' && character <= 'F' ? character - 'A' + 10
+		: 16;
+}
+
+// parses an integer literal with the prefixes of c++: 0x hex, 0b binary, a leading 0 octal, decimal otherwise
+template <std::size_t N>
+constexpr BigIntConstant<N> parse_big_literal(const char* text, std::size_t count)
+{
+	BigInt::limb_t base = 10;
+	std::size_t start = 0;
+	if (count > 1 && text[0] == '0') {
+		bool is_hex = text[1] == 'x' || text[1] == 'X';
+		bool is_binary = text[1] == 'b' || text[1] == 'B';
+		base = is_hex ? 16 : is_binary ? 2 : 8;
+		start = is_hex || is_binary ? 2 : 1;
+	}
+
+	BigIntConstant<N> result;
+	for (std::size_t i = start; i < count; i++) {
+		if (text[i] == '\'')
+			continue;
+
+		BigInt::limb_t digit = big_literal_digit(text[i]);
+		assert(digit < base);
+		result.mul_add_small(base, digit);
+	}
+
+	return result;
+}
+
+// 123456789012345678901234567890_big is a BigIntConstant computed by the compiler
+// one limb holds at least 8 digits of any supported base (exactly 8 for hex), so count / 8 + 1 limbs are always enough
+template <char... characters>
+constexpr BigIntConstant<sizeof...(characters) / 8 + 1> operator""_big()
+{
+	constexpr char text[] = { characters... };
+	return parse_big_literal<sizeof...(characters) / 8 + 1>(text, sizeof...(characters));
+}
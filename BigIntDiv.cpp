@@ -0,0 +1,301 @@
+#include "BigIntLimbs.h"
+#include "FixedBigInt.h"
+
+#include <algorithm>
+#include <cassert>
+
+// -----------------------
+// -- Tunable thresholds
+// -----------------------
+
+std::size_t BigInt::newton_division_threshold = 8192;
+
+namespace bigint_limbs
+{
+	// -----------------------
+	// -- Internal Util functions
+	// -----------------------
+
+	// number of leading zero bits of a non zero limb
+	static unsigned leading_zeros(limb_t limb)
+	{
+		unsigned count = 0;
+		while ((limb & (limb_t(1) << (BigInt::LIMB_BITS - 1))) == 0) {
+			limb <<= 1;
+			count++;
+		}
+
+		return count;
+	}
+
+	static void increment(limb_vector& a)
+	{
+		limb_t one = 1;
+		if (add(a.data(), a.data(), a.size(), &one, 1) > 0)
+			a.push_back(1);
+	}
+
+	// knuth's algorithm D (taocp vol. 2, 4.3.1)
+	// u has u_length limbs, v is normalized (highest bit set) and has v_length >= 2 limbs
+	// the top limb of u has to be smaller than the top limb of v, usually it is a zero padding limb
+	// writes u_length - v_length limbs to quotient, u is replaced by the remainder in its lower v_length limbs
+	static void divmod_knuth(limb_t* quotient, limb_t* u, std::size_t u_length, const limb_t* v, std::size_t v_length)
+	{
+		const double_limb_t base = double_limb_t(1) << BigInt::LIMB_BITS;
+		const double_limb_t limb_mask = base - 1;
+		const limb_t v_top = v[v_length - 1];
+		const limb_t v_second = v[v_length - 2];
+
+		for (std::size_t j = u_length - v_length; j-- > 0;) {
+			// estimate the quotient limb from the top two limbs, it is at most two too big
+			double_limb_t numerator = (static_cast<double_limb_t>(u[j + v_length]) << BigInt::LIMB_BITS) | u[j + v_length - 1];
+			double_limb_t quotient_estimate = numerator / v_top;
+			double_limb_t remainder_estimate = numerator % v_top;
+
+			while (quotient_estimate >= base || quotient_estimate * v_second > ((remainder_estimate << BigInt::LIMB_BITS) | u[j + v_length - 2])) {
+				quotient_estimate--;
+				remainder_estimate += v_top;
+				if (remainder_estimate >= base)
+					break;
+			}
+
+			// multiply and subtract
+			std::int64_t borrow = 0;
+			std::int64_t difference = 0;
+			for (std::size_t i = 0; i < v_length; i++) {
+				double_limb_t product = quotient_estimate * v[i];
+				difference = static_cast<std::int64_t>(u[i + j]) - borrow - static_cast<std::int64_t>(product & limb_mask);
+				u[i + j] = static_cast<limb_t>(difference);
+				borrow = static_cast<std::int64_t>(product >> BigInt::LIMB_BITS) - (difference >> BigInt::LIMB_BITS);
+			}
+			difference = static_cast<std::int64_t>(u[j + v_length]) - borrow;
+			u[j + v_length] = static_cast<limb_t>(difference);
+
+			// the estimate was still one too big, add back
+			if (difference < 0) {
+				quotient_estimate--;
+				limb_t carry = add(u + j, u + j, v_length, v, v_length);
+				u[j + v_length] += carry;
+			}
+
+			quotient[j] = static_cast<limb_t>(quotient_estimate);
+		}
+	}
+
+	// -----------------------
+	// -- Newton division
+	// -----------------------
+
+	// newton iteration on the upper half of v, every level is corrected to the exact value
+	limb_vector reciprocal(const limb_t* v, std::size_t v_length)
+	{
+		std::size_t n = v_length;
+		limb_vector power(2 * n + 1, 0);
+		power[2 * n] = 1;
+
+		if (n < 2 || n < BigInt::newton_division_threshold) {
+			limb_vector result(n + 2, 0);
+			if (n == 1) {
+				// single limb divisor, no normalization needed for the short division
+				div_small(power.data(), power.size(), v[0]);
+				std::copy(power.begin(), power.begin() + n + 1, result.begin());
+			}
+			else {
+				power.push_back(0);
+				divmod_knuth(result.data(), power.data(), power.size(), v, n);
+			}
+			result.resize(n + 1);
+			return result;
+		}
+
+		// 1. reciprocal of the upper half, rounded up so x0 never overestimates
+		std::size_t h = (n + 1) / 2;
+		limb_vector v_high(v + n - h, v + n);
+		increment(v_high);
+		limb_vector y;
+		if (v_high.size() > h) {
+			// v_high + 1 overflowed to B^h, so its reciprocal is exactly B^h
+			y.assign(h + 1, 0);
+			y[h] = 1;
+		}
+		else {
+			y = reciprocal(v_high.data(), h);
+		}
+
+		// x0 = y * B^(n - h)
+		limb_vector x(n + 1, 0);
+		std::copy(y.begin(), y.end(), x.begin() + (n - h));
+
+		// 2. one newton step: x1 = x0 + x0 * (B^(2n) - v * x0) / B^(2n)
+		limb_vector product(2 * n + 1);
+		mul(product.data(), v, n, x.data(), n + 1);
+		limb_vector error(2 * n + 1);
+		limb_t borrow = sub(error.data(), power.data(), 2 * n + 1, product.data(), 2 * n + 1);
+		assert(borrow == 0);
+		(void)borrow;
+
+		std::size_t error_length = trimmed_length(error.data(), error.size());
+		limb_vector correction(n + 1 + error_length);
+		mul(correction.data(), x.data(), n + 1, error.data(), error_length);
+		if (correction.size() > 2 * n) {
+			std::size_t correction_length = trimmed_length(correction.data() + 2 * n, correction.size() - 2 * n);
+			add(x.data(), x.data(), n + 1, correction.data() + 2 * n, std::min(correction_length, n + 1));
+		}
+
+		// 3. x1 is still an underestimate by a few units, correct it to the floor
+		mul(product.data(), v, n, x.data(), n + 1);
+		sub(error.data(), power.data(), 2 * n + 1, product.data(), 2 * n + 1);
+		while (cmp(error.data(), trimmed_length(error.data(), error.size()), v, n) != CMP_SECOND_PARAMETER_BIGGER) {
+			sub(error.data(), error.data(), error.size(), v, n);
+			increment(x);
+		}
+
+		x.resize(n + 1);
+		return x;
+	}
+
+	// divides a block of 2n limbs, which is smaller than v * B^n, by the normalized v of n limbs
+	// uses the reciprocal x = floor(B^(2n) / v), writes n quotient limbs and n remainder limbs
+	static void divmod_block(limb_t* quotient, limb_t* remainder, const limb_t* block, const limb_t* v, std::size_t n, const limb_t* x)
+	{
+		// q = (block / B^(n - 1)) * x / B^(n + 1) never overestimates the quotient and is off by a few units at most
+		// the lower n - 1 limbs of the block hardly change the quotient, so only the upper n + 1 limbs are multiplied
+		limb_vector product(2 * n + 2);
+		mul(product.data(), block + n - 1, n + 1, x, n + 1);
+		limb_vector q(product.begin() + n + 1, product.end());
+
+		limb_vector q_times_v(2 * n + 1);
+		mul(q_times_v.data(), q.data(), n + 1, v, n);
+		limb_vector rest(2 * n + 1, 0);
+		std::copy(block, block + 2 * n, rest.begin());
+		limb_t borrow = sub(rest.data(), rest.data(), 2 * n + 1, q_times_v.data(), 2 * n + 1);
+		assert(borrow == 0);
+		(void)borrow;
+
+		while (cmp(rest.data(), trimmed_length(rest.data(), rest.size()), v, n) != CMP_SECOND_PARAMETER_BIGGER) {
+			sub(rest.data(), rest.data(), rest.size(), v, n);
+			increment(q);
+		}
+
+		assert(trimmed_length(q.data(), q.size()) <= n);
+		std::copy(q.begin(), q.begin() + n, quotient);
+		std::copy(rest.begin(), rest.begin() + n, remainder);
+	}
+
+	// newton division of u by the normalized v of n limbs, u is processed in blocks of n limbs from the top
+	// like a long division in base B^n, every block step costs a few multiplications of size n
+	static void divmod_newton(limb_t* quotient, limb_t* u, std::size_t u_length, const limb_t* v, std::size_t n, const limb_t* x)
+	{
+		std::size_t block_count = (u_length + n - 1) / n;
+		limb_vector padded(block_count * n, 0);
+		std::copy(u, u + u_length, padded.begin());
+		limb_vector padded_quotient(block_count * n, 0);
+
+		// window = remainder * B^n + next block
+		limb_vector window(2 * n, 0);
+		for (std::size_t i = block_count; i-- > 0;) {
+			std::copy(padded.begin() + i * n, padded.begin() + (i + 1) * n, window.begin());
+
+			// the quotient of a leading block below v is zero, the block just moves up as the remainder
+			// this skips the mostly empty top block of a padded dividend
+			bool is_remainder_zero = trimmed_length(window.data() + n, n) == 0;
+			if (is_remainder_zero && cmp(window.data(), trimmed_length(window.data(), n), v, n) == CMP_SECOND_PARAMETER_BIGGER) {
+				std::copy(window.begin(), window.begin() + n, window.begin() + n);
+				continue;
+			}
+
+			divmod_block(padded_quotient.data() + i * n, window.data() + n, window.data(), v, n, x);
+		}
+
+		std::copy(window.begin() + n, window.end(), u);
+		std::fill(u + n, u + u_length, 0);
+		std::copy(padded_quotient.begin(), padded_quotient.begin() + (u_length - n), quotient);
+	}
+
+	// -----------------------
+	// -- Division
+	// -----------------------
+
+	void divmod(limb_t* quotient, limb_t* remainder, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length)
+	{
+		assert(b_length > 0 && b[b_length - 1] != 0);
+		assert(a_length >= b_length);
+
+		std::size_t quotient_length = a_length - b_length + 1;
+
+		if (b_length == 1) {
+			std::copy(a, a + a_length, quotient);
+			remainder[0] = div_small(quotient, a_length, b[0]);
+			return;
+		}
+
+		// normalize so the highest bit of the divisor is set, the quotient does not change
+		unsigned shift = leading_zeros(b[b_length - 1]);
+		limb_vector v(b_length + 1);
+		v[b_length] = shift_left(v.data(), b, b_length, shift);
+
+		bool use_newton = b_length >= BigInt::newton_division_threshold && quotient_length >= BigInt::newton_division_threshold;
+		if (use_newton) {
+			limb_vector x = reciprocal(v.data(), b_length);
+			divmod_preinverted(quotient, remainder, a, a_length, v.data(), b_length, shift, x.data());
+			return;
+		}
+
+		limb_vector u(a_length + 1);
+		u[a_length] = shift_left(u.data(), a, a_length, shift);
+		divmod_knuth(quotient, u.data(), u.size(), v.data(), b_length);
+
+		// undo the normalization on the remainder
+		shift_right(remainder, u.data(), b_length, shift);
+	}
+
+	unsigned normalization_shift(const limb_t* b, std::size_t b_length)
+	{
+		return leading_zeros(b[b_length - 1]);
+	}
+
+	void divmod_preinverted(limb_t* quotient, limb_t* remainder, const limb_t* a, std::size_t a_length, const limb_t* v, std::size_t v_length, unsigned shift, const limb_t* x)
+	{
+		assert(v_length >= 2 && a_length >= v_length);
+
+		limb_vector u(a_length + 1);
+		u[a_length] = shift_left(u.data(), a, a_length, shift);
+		divmod_newton(quotient, u.data(), u.size(), v, v_length, x);
+		shift_right(remainder, u.data(), v_length, shift);
+	}
+
+	void divmod_fixed(limb_t* quotient, limb_t* remainder, const limb_t* a, const limb_t* b, std::size_t length, limb_t* scratch)
+	{
+		std::size_t a_length = trimmed_length(a, length);
+		std::size_t b_length = trimmed_length(b, length);
+		assert(b_length > 0);
+
+		// the results may overwrite the operands, so the work goes through the scratch: u, v and the quotient
+		limb_t* u = scratch;
+		limb_t* v = u + length + 1;
+		limb_t* q = v + length;
+		std::fill(q, q + length, 0);
+
+		std::size_t remainder_length = b_length;
+		if (a_length < b_length) {
+			std::copy(a, a + a_length, u);
+			remainder_length = a_length;
+		}
+		else if (b_length == 1) {
+			std::copy(a, a + a_length, q);
+			u[0] = div_small(q, a_length, b[0]);
+		}
+		else {
+			// knuth's algorithm D on the normalized copies, fixed widths never reach the newton division
+			unsigned shift = leading_zeros(b[b_length - 1]);
+			shift_left(v, b, b_length, shift);
+			u[a_length] = shift_left(u, a, a_length, shift);
+			divmod_knuth(q, u, a_length + 1, v, b_length);
+			shift_right(u, u, b_length, shift);
+		}
+
+		std::fill(remainder, remainder + length, 0);
+		std::copy(u, u + remainder_length, remainder);
+		std::copy(q, q + length, quotient);
+	}
+}
@@ -0,0 +1,521 @@
+#include "BigIntGcd.h"
+#include "BigIntLimbs.h"
+#include "BigIntView.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+
+// -----------------------
+// -- Tunable thresholds
+// -----------------------
+
+std::size_t BigInt::half_gcd_threshold = 1000;
+
+namespace bigint_limbs
+{
+	// -----------------------
+	// -- Internal Constants for lehmer's algorithm
+	// -----------------------
+
+	// leading bits of the numbers one lehmer step works on, so x + A fits into a signed 64 bit value
+	const unsigned LEHMER_BITS = 62;
+	// the cofactors stay below 2^32, so they can be applied to the numbers with one limb multiplications
+	const std::int64_t LEHMER_COFACTOR_LIMIT = 0xFFFFFFFF;
+
+	// -----------------------
+	// -- Internal Util functions
+	// -----------------------
+
+	// the LEHMER_BITS bits of a starting at bit shift, bits beyond its length are zero
+	static std::int64_t leading_bits(const limb_t* a, std::size_t length, std::size_t shift)
+	{
+		auto limb = [&](std::size_t index) { return static_cast<std::uint64_t>(index < length ? a[index] : 0); };
+
+		std::size_t index = shift / BigInt::LIMB_BITS;
+		unsigned offset = shift % BigInt::LIMB_BITS;
+		std::uint64_t value = (limb(index) | limb(index + 1) << BigInt::LIMB_BITS) >> offset;
+		if (offset > 0)
+			value |= limb(index + 2) << (2 * BigInt::LIMB_BITS - offset);
+		return static_cast<std::int64_t>(value & ((std::uint64_t(1) << LEHMER_BITS) - 1));
+	}
+
+	static std::uint64_t gcd_binary(std::uint64_t a, std::uint64_t b)
+	{
+		if (a == 0 || b == 0)
+			return a | b;
+
+		// the common factors of two, then both stay odd
+		unsigned shift = 0;
+		while (((a | b) & 1) == 0) {
+			a >>= 1;
+			b >>= 1;
+			shift++;
+		}
+		while ((a & 1) == 0)
+			a >>= 1;
+
+		do {
+			while ((b & 1) == 0)
+				b >>= 1;
+			if (a > b)
+				std::swap(a, b);
+			b -= a;
+		} while (b != 0);
+
+		return a << shift;
+	}
+
+	// a number of at most two limbs as one word
+	static std::uint64_t to_word(const limb_t* a, std::size_t length)
+	{
+		return (length > 0 ? a[0] : 0) | (length > 1 ? static_cast<std::uint64_t>(a[1]) << BigInt::LIMB_BITS : 0);
+	}
+
+	static BigInt to_big(std::uint64_t value)
+	{
+		limb_t limbs[2] = { static_cast<limb_t>(value), static_cast<limb_t>(value >> BigInt::LIMB_BITS) };
+		return BigInt(BigIntView(limbs, 2, false));
+	}
+
+	static BigInt to_big(const limb_vector& a)
+	{
+		return BigInt(BigIntView(a.data(), a.size(), false));
+	}
+
+	// the absolute value of b as limbs, returns true if b was negative
+	static bool assign_magnitude(limb_vector& destination, const BigInt& b)
+	{
+		BigIntView view(b);
+		destination.assign(view.get_limbs(), view.get_limbs() + view.get_length());
+		return view.get_is_negative();
+	}
+
+	static void negate(BigInt& b)
+	{
+		b = BigInt(0) - std::move(b);
+	}
+
+	// -----------------------
+	// -- Internal Lehmer steps
+	// -----------------------
+
+	// (a, b) becomes (m00 * a + m01 * b, m10 * a + m11 * b)
+	// the two entries of a row have opposite signs or one of them is zero, all are below 2^32
+	struct LehmerMatrix
+	{
+		std::int64_t m00, m01, m10, m11;
+	};
+
+	// true if next = current - q * previous could go beyond LEHMER_COFACTOR_LIMIT
+	// q and the cofactors are below 2^32, so the product fits into 64 bits and no division is needed
+	static bool exceeds_limit(std::int64_t q, std::int64_t previous, std::int64_t current)
+	{
+		std::uint64_t product = static_cast<std::uint64_t>(q) * static_cast<std::uint64_t>(previous < 0 ? -previous : previous);
+		return product > static_cast<std::uint64_t>(LEHMER_COFACTOR_LIMIT - (current < 0 ? -current : current));
+	}
+
+	// numerator / divisor for positive values
+	// most quotients of the euclidean algorithm are small, a few subtractions are faster than a division then
+	static std::int64_t quotient(std::int64_t numerator, std::int64_t divisor)
+	{
+		std::int64_t q = 0;
+		for (; q < 4 && numerator >= divisor; q++)
+			numerator -= divisor;
+		return numerator >= divisor ? q + numerator / divisor : q;
+	}
+
+	// knuth's algorithm L: the euclidean steps on the leading LEHMER_BITS bits of a and the same bits of b, a >= b > 0
+	// a quotient is only taken if the bounds for both ends of the cut off bits agree, so the matrix is exact for a and b
+	// returns false if not even the first quotient was certain, e.g. because it is too big
+	static bool lehmer_matrix(const limb_vector& a, const limb_vector& b, LehmerMatrix& m)
+	{
+		std::size_t bits = bit_length(a.data(), a.size());
+		std::size_t shift = bits > LEHMER_BITS ? bits - LEHMER_BITS : 0;
+		std::int64_t x = leading_bits(a.data(), a.size(), shift);
+		std::int64_t y = leading_bits(b.data(), b.size(), shift);
+
+		m = { 1, 0, 0, 1 };
+		while (y + m.m10 != 0 && y + m.m11 != 0) {
+			std::int64_t divisor = y + m.m10;
+			std::int64_t q = quotient(x + m.m00, divisor);
+			if (q > LEHMER_COFACTOR_LIMIT || exceeds_limit(q, m.m10, m.m00) || exceeds_limit(q, m.m11, m.m01))
+				break;
+
+			// the other bound gives the same quotient if (x + m01) - q * (y + m11) is in [0, y + m11)
+			// written with the first remainder, so all products stay small
+			std::int64_t remainder = (x + m.m00 - q * divisor) + (m.m01 - m.m00) - q * (m.m11 - m.m10);
+			if (remainder < 0 || remainder >= y + m.m11)
+				break;
+
+			std::int64_t next = m.m00 - q * m.m10;
+			m.m00 = m.m10;
+			m.m10 = next;
+			next = m.m01 - q * m.m11;
+			m.m01 = m.m11;
+			m.m11 = next;
+			next = x - q * y;
+			x = y;
+			y = next;
+		}
+
+		return m.m01 != 0;
+	}
+
+	// destination = f * a + g * b for f and g of opposite signs with a result >= 0
+	// b is padded to the length of a, destination needs length + 1 limbs, returns the length without leading zeros
+	static std::size_t combine(limb_t* destination, const limb_t* a, const limb_t* b, std::size_t length, std::int64_t f, std::int64_t g)
+	{
+		// the positive term first, then g <= 0
+		if (f < 0 || g > 0) {
+			std::swap(a, b);
+			std::swap(f, g);
+		}
+
+		std::fill(destination, destination + length, 0);
+		destination[length] = addmul_small(destination, a, length, static_cast<limb_t>(f));
+		limb_t borrow = submul_small(destination, b, length, static_cast<limb_t>(-g));
+		assert(destination[length] >= borrow);
+		destination[length] -= borrow;
+		return trimmed_length(destination, length + 1);
+	}
+
+	// (a, b) = (m00 * a + m01 * b, m10 * a + m11 * b), the scratch vectors keep their buffers for the next step
+	static void apply_lehmer(limb_vector& a, limb_vector& b, const LehmerMatrix& m, limb_vector& scratch_a, limb_vector& scratch_b)
+	{
+		std::size_t length = a.size();
+		b.resize(length);
+		scratch_a.resize(length + 1);
+		scratch_b.resize(length + 1);
+		scratch_a.resize(combine(scratch_a.data(), a.data(), b.data(), length, m.m00, m.m01));
+		scratch_b.resize(combine(scratch_b.data(), a.data(), b.data(), length, m.m10, m.m11));
+		std::swap(a, scratch_a);
+		std::swap(b, scratch_b);
+	}
+
+	// a, b = b, a mod b, returns the quotient
+	static limb_vector euclid_step(limb_vector& a, limb_vector& b)
+	{
+		limb_vector quotient(a.size() - b.size() + 1);
+		limb_vector remainder(b.size());
+		divmod(quotient.data(), remainder.data(), a.data(), a.size(), b.data(), b.size());
+		quotient.resize(trimmed_length(quotient.data(), quotient.size()));
+		remainder.resize(trimmed_length(remainder.data(), remainder.size()));
+
+		a = std::move(b);
+		b = std::move(remainder);
+		return quotient;
+	}
+
+	// destination = f * x + g * y
+	static void add_multiples(limb_vector& destination, const limb_vector& x, limb_t f, const limb_vector& y, limb_t g)
+	{
+		// both products have at most one limb more than their operand, the sum one more again
+		std::size_t length = std::max(x.size(), y.size()) + 2;
+		destination.assign(length, 0);
+		destination[x.size()] = addmul_small(destination.data(), x.data(), x.size(), f);
+		limb_t carry = addmul_small(destination.data(), y.data(), y.size(), g);
+		add(destination.data() + y.size(), destination.data() + y.size(), length - y.size(), &carry, 1);
+		destination.resize(trimmed_length(destination.data(), length));
+	}
+
+	// -----------------------
+	// -- Internal Remainder pair
+	// -----------------------
+
+	// the two remainders a >= b of the euclidean algorithm, both without leading zero limbs
+	// the rows of the matrix which turned the inputs into (a, b) are tracked for as many columns as needed:
+	// a = top[0] * first input + top[1] * second input, b = bottom[0] * first input + bottom[1] * second input
+	// gcd tracks no column, ext_gcd only the first one and the half gcd both
+	struct RemainderPair
+	{
+		limb_vector a;
+		limb_vector b;
+		std::size_t column_count;
+		BigInt top[2];
+		BigInt bottom[2];
+		// true as long as the matrix is the identity, then the first matrix is taken over instead of multiplied
+		bool is_identity;
+
+		RemainderPair(limb_vector a, limb_vector b, std::size_t column_count) : a(std::move(a)), b(std::move(b)), column_count(column_count), top{ 1, 0 }, bottom{ 0, 1 }, is_identity(true) {}
+	};
+
+	static void swap_rows(RemainderPair& pair)
+	{
+		std::swap(pair.a, pair.b);
+		for (std::size_t i = 0; i < pair.column_count; i++)
+			std::swap(pair.top[i], pair.bottom[i]);
+		pair.is_identity = false;
+	}
+
+	// rows = (m00 * top + m01 * bottom, m10 * top + m11 * bottom) for every tracked column
+	static void combine_rows(RemainderPair& pair, const BigInt& m00, const BigInt& m01, const BigInt& m10, const BigInt& m11)
+	{
+		if (pair.is_identity) {
+			const BigInt* columns[2][2] = { { &m00, &m10 }, { &m01, &m11 } };
+			for (std::size_t i = 0; i < pair.column_count; i++) {
+				pair.top[i] = *columns[i][0];
+				pair.bottom[i] = *columns[i][1];
+			}
+			pair.is_identity = false;
+			return;
+		}
+
+		for (std::size_t i = 0; i < pair.column_count; i++) {
+			BigInt top = m00 * pair.top[i] + m01 * pair.bottom[i];
+			pair.bottom[i] = m10 * pair.top[i] + m11 * pair.bottom[i];
+			pair.top[i] = std::move(top);
+		}
+	}
+
+	static void euclid_step(RemainderPair& pair)
+	{
+		limb_vector quotient = euclid_step(pair.a, pair.b);
+		if (pair.column_count > 0)
+			combine_rows(pair, 0, 1, 1, BigInt(0) - to_big(quotient));
+	}
+
+	// (a, b) = (m00 * a + m01 * b, m10 * a + m11 * b) for an integer matrix m of determinant +-1
+	// the results may come out negative or in the wrong order when m was taken from the leading limbs only,
+	// the rows are fixed up then, which keeps the gcd since every such matrix does
+	static void apply_matrix(RemainderPair& pair, const RemainderPair& m)
+	{
+		BigInt a = to_big(pair.a);
+		BigInt b = to_big(pair.b);
+		bool is_a_negative = assign_magnitude(pair.a, m.top[0] * a + m.top[1] * b);
+		bool is_b_negative = assign_magnitude(pair.b, m.bottom[0] * a + m.bottom[1] * b);
+		combine_rows(pair, m.top[0], m.top[1], m.bottom[0], m.bottom[1]);
+
+		for (std::size_t i = 0; i < pair.column_count; i++) {
+			if (is_a_negative)
+				negate(pair.top[i]);
+			if (is_b_negative)
+				negate(pair.bottom[i]);
+		}
+		if (cmp(pair.a.data(), pair.a.size(), pair.b.data(), pair.b.size()) == CMP_SECOND_PARAMETER_BIGGER)
+			swap_rows(pair);
+	}
+
+	// lehmer and division steps until b has at most stop_length limbs, or a fits into one word if no column is tracked
+	// the cofactors of these exact steps alternate in sign like in the extended euclidean algorithm,
+	// so they are kept as absolute values which only ever add up, and go into the tracked columns once at the end
+	static void lehmer_reduce(RemainderPair& pair, std::size_t stop_length)
+	{
+		bool has_columns = pair.column_count > 0;
+		// starting from the identity only the tracked columns are needed, otherwise the whole matrix
+		std::size_t cofactor_columns = pair.is_identity ? pair.column_count : 2;
+		limb_vector cofactors[2][2];
+		if (has_columns) {
+			cofactors[0][0].assign(1, 1);
+			cofactors[1][1].assign(1, 1);
+		}
+		// the sign of the top left cofactor, the others follow from it
+		bool is_odd = false;
+
+		limb_vector scratch_a;
+		limb_vector scratch_b;
+		limb_vector next_top;
+		limb_vector next_bottom;
+		while (pair.b.size() > stop_length && (has_columns || pair.a.size() > 2)) {
+			LehmerMatrix m;
+			if (lehmer_matrix(pair.a, pair.b, m)) {
+				apply_lehmer(pair.a, pair.b, m, scratch_a, scratch_b);
+				if (!has_columns)
+					continue;
+
+				// m01 is positive after an odd number of steps
+				is_odd = is_odd != (m.m01 > 0);
+				for (std::size_t i = 0; i < cofactor_columns; i++) {
+					add_multiples(next_top, cofactors[0][i], static_cast<limb_t>(m.m00 < 0 ? -m.m00 : m.m00), cofactors[1][i], static_cast<limb_t>(m.m01 < 0 ? -m.m01 : m.m01));
+					add_multiples(next_bottom, cofactors[0][i], static_cast<limb_t>(m.m10 < 0 ? -m.m10 : m.m10), cofactors[1][i], static_cast<limb_t>(m.m11 < 0 ? -m.m11 : m.m11));
+					std::swap(cofactors[0][i], next_top);
+					std::swap(cofactors[1][i], next_bottom);
+				}
+			}
+			else {
+				limb_vector quotient = euclid_step(pair.a, pair.b);
+				if (!has_columns)
+					continue;
+
+				// bottom = top + q * bottom, as the signs of top and bottom differ
+				is_odd = !is_odd;
+				for (std::size_t i = 0; i < cofactor_columns; i++) {
+					limb_vector& top = cofactors[0][i];
+					limb_vector& bottom = cofactors[1][i];
+					next_bottom.assign(std::max(top.size(), quotient.size() + bottom.size()) + 1, 0);
+					if (!bottom.empty())
+						mul(next_bottom.data(), quotient.data(), quotient.size(), bottom.data(), bottom.size());
+					add(next_bottom.data(), next_bottom.data(), next_bottom.size(), top.data(), top.size());
+					next_bottom.resize(trimmed_length(next_bottom.data(), next_bottom.size()));
+					std::swap(top, bottom);
+					std::swap(bottom, next_bottom);
+				}
+			}
+		}
+
+		if (has_columns) {
+			BigInt m00(BigIntView(cofactors[0][0].data(), cofactors[0][0].size(), is_odd));
+			BigInt m01(BigIntView(cofactors[0][1].data(), cofactors[0][1].size(), !is_odd));
+			BigInt m10(BigIntView(cofactors[1][0].data(), cofactors[1][0].size(), !is_odd));
+			BigInt m11(BigIntView(cofactors[1][1].data(), cofactors[1][1].size(), is_odd));
+			combine_rows(pair, m00, m01, m10, m11);
+		}
+	}
+
+	// -----------------------
+	// -- Internal Half gcd
+	// -----------------------
+
+	// the limbs of a from offset on
+	static limb_vector leading_limbs(const limb_vector& a, std::size_t offset)
+	{
+		return offset < a.size() ? limb_vector(a.begin() + offset, a.end()) : limb_vector();
+	}
+
+	// reduces a >= b > 0 of n limbs to remainders of about n / 2 limbs in subquadratic time
+	// the first half of the quotients only depends on the leading half of the limbs, so a recursive call on them
+	// gives a matrix which is applied to the full numbers, then the same again for the second half
+	static void half_gcd(RemainderPair& pair)
+	{
+		std::size_t n = pair.a.size();
+		std::size_t target = n / 2 + 1;
+		if (n < BigInt::half_gcd_threshold || n < 4) {
+			lehmer_reduce(pair, target);
+			return;
+		}
+
+		// the leading n - n / 2 limbs are reduced to about a quarter, the full numbers to about 3n / 4 limbs
+		std::size_t offset = n / 2;
+		RemainderPair first(leading_limbs(pair.a, offset), leading_limbs(pair.b, offset), 2);
+		half_gcd(first);
+		apply_matrix(pair, first);
+
+		if (pair.b.size() <= target)
+			return;
+		// a big quotient here would stall the second half
+		euclid_step(pair);
+		if (pair.b.size() <= target)
+			return;
+
+		// the leading 2 * (length - target) limbs decide the quotients down to the target
+		offset = pair.a.size() < 2 * target ? 2 * target - pair.a.size() : 0;
+		RemainderPair second(leading_limbs(pair.a, offset), leading_limbs(pair.b, offset), 2);
+		half_gcd(second);
+		apply_matrix(pair, second);
+	}
+
+	// runs the euclidean algorithm on the pair until b is zero, a is the gcd then
+	static void reduce(RemainderPair& pair)
+	{
+		while (!pair.b.empty()) {
+			if (pair.b.size() >= BigInt::half_gcd_threshold) {
+				RemainderPair halved(std::move(pair.a), std::move(pair.b), 2);
+				half_gcd(halved);
+				pair.a = std::move(halved.a);
+				pair.b = std::move(halved.b);
+				if (pair.column_count > 0)
+					combine_rows(pair, halved.top[0], halved.top[1], halved.bottom[0], halved.bottom[1]);
+				// ends the loop even if the half gcd made no progress
+				if (!pair.b.empty())
+					euclid_step(pair);
+			}
+			else if (pair.column_count == 0 && pair.a.size() <= 2) {
+				// the rest fits into one word
+				std::uint64_t g = gcd_binary(to_word(pair.a.data(), pair.a.size()), to_word(pair.b.data(), pair.b.size()));
+				limb_t limbs[2] = { static_cast<limb_t>(g), static_cast<limb_t>(g >> BigInt::LIMB_BITS) };
+				pair.a.assign(limbs, limbs + trimmed_length(limbs, 2));
+				pair.b.clear();
+			}
+			else {
+				lehmer_reduce(pair, 0);
+			}
+		}
+	}
+
+	// the remainder pair of |a| and |b| with the bigger one first
+	static RemainderPair make_pair(const BigIntView& a, const BigIntView& b, std::size_t column_count)
+	{
+		RemainderPair pair(limb_vector(a.get_limbs(), a.get_limbs() + a.get_length()), limb_vector(b.get_limbs(), b.get_limbs() + b.get_length()), column_count);
+		if (a.cmp_absolute(b) == CMP_SECOND_PARAMETER_BIGGER)
+			swap_rows(pair);
+		return pair;
+	}
+}
+
+using namespace bigint_limbs;
+
+// -----------------------
+// -- Gcd
+// -----------------------
+
+BigInt gcd(const BigInt& a, const BigInt& b)
+{
+	BigIntView view_a(a);
+	BigIntView view_b(b);
+
+	// small numbers, e.g. of fractions, do without any allocation
+	if (view_a.get_length() <= 2 && view_b.get_length() <= 2)
+		return to_big(gcd_binary(to_word(view_a.get_limbs(), view_a.get_length()), to_word(view_b.get_limbs(), view_b.get_length())));
+
+	RemainderPair pair = make_pair(view_a, view_b, 0);
+	reduce(pair);
+	return to_big(pair.a);
+}
+
+BigInt lcm(const BigInt& a, const BigInt& b)
+{
+	BigIntView view_a(a);
+	BigIntView view_b(b);
+	if (view_a.get_length() == 0 || view_b.get_length() == 0)
+		return BigInt(0);
+
+	BigInt result(BigIntView(view_a.get_limbs(), view_a.get_length(), false));
+	result /= gcd(a, b);
+	result *= BigIntView(view_b.get_limbs(), view_b.get_length(), false);
+	return result;
+}
+
+BigInt ext_gcd(const BigInt& a, const BigInt& b, BigInt& x, BigInt& y)
+{
+	BigIntView view_a(a);
+	BigIntView view_b(b);
+
+	// only the cofactor of |a| is tracked, y follows from it
+	RemainderPair pair = make_pair(view_a, view_b, 1);
+	reduce(pair);
+	BigInt g = to_big(pair.a);
+
+	if (view_b.get_length() == 0) {
+		x = view_a.get_length() == 0 ? 0 : (view_a.get_is_negative() ? -1 : 1);
+		y = 0;
+		return g;
+	}
+
+	// all solutions differ by multiples of |b| / g
+	BigInt cofactor = std::move(pair.top[0]);
+	if (view_a.get_is_negative())
+		negate(cofactor);
+	BigInt period(BigIntView(view_b.get_limbs(), view_b.get_length(), false));
+	period /= g;
+	cofactor %= period;
+	if (BigIntView(cofactor).get_is_negative())
+		cofactor += period;
+
+	// a and b may be x and y
+	BigInt other = g - a * cofactor;
+	other /= b;
+	x = std::move(cofactor);
+	y = std::move(other);
+	return g;
+}
+
+BigInt mod_inverse(const BigInt& a, const BigInt& modulus)
+{
+	assert(!BigIntView(modulus).get_is_negative() && modulus > 1);
+
+	BigInt x(0);
+	BigInt y(0);
+	BigInt g = ext_gcd(a, modulus, x, y);
+	return g == 1 ? x : BigInt(0);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "BigInt.h"
+
+// greatest common divisor and the functions built on it
+// lehmer's algorithm does the work with one limb cofactors, very big numbers are first halved by a recursive half gcd
+// all of them only look at the absolute values of the operands, the signs only matter for the cofactors
+
+// the greatest common divisor of a and b, never negative, gcd(0, 0) is 0
+BigInt gcd(const BigInt& a, const BigInt& b);
+
+// the least common multiple of a and b, never negative, 0 if a or b is 0
+BigInt lcm(const BigInt& a, const BigInt& b);
+
+// returns g = gcd(a, b) and cofactors with a * x + b * y = g
+// for b != 0, x is the one with 0 <= x < |b| / g, for b == 0, x is the sign of a and y is 0
+BigInt ext_gcd(const BigInt& a, const BigInt& b, BigInt& x, BigInt& y);
+
+// the x in [0, modulus) with a * x = 1 mod modulus, the modulus has to be bigger than 1
+// returns 0 if a and the modulus have a common divisor, so there is no inverse
+BigInt mod_inverse(const BigInt& a, const BigInt& modulus);
@@ -0,0 +1,297 @@
+#include "BigIntLimbs.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace bigint_limbs
+{
+	std::size_t trimmed_length(const limb_t* a, std::size_t length)
+	{
+		while (length > 0 && a[length - 1] == 0)
+			length--;
+
+		return length;
+	}
+
+	// -----------------------
+	// -- Basic kernels
+	// -----------------------
+
+	limb_t add_n_portable(limb_t* destination, const limb_t* a, const limb_t* b, std::size_t length, limb_t carry)
+	{
+		double_limb_t sum_carry = carry;
+		for (std::size_t i = 0; i < length; i++) {
+			double_limb_t current = static_cast<double_limb_t>(a[i]) + b[i] + sum_carry;
+			destination[i] = static_cast<limb_t>(current);
+			sum_carry = current >> BigInt::LIMB_BITS;
+		}
+
+		return static_cast<limb_t>(sum_carry);
+	}
+
+	limb_t sub_n_portable(limb_t* destination, const limb_t* a, const limb_t* b, std::size_t length, limb_t borrow)
+	{
+		for (std::size_t i = 0; i < length; i++) {
+			double_limb_t subtrahend = static_cast<double_limb_t>(b[i]) + borrow;
+			bool is_diff_negative = a[i] < subtrahend;
+			// wraps around modulo 2^32 which is exactly the borrowed value
+			destination[i] = static_cast<limb_t>(a[i] - subtrahend);
+			borrow = is_diff_negative;
+		}
+
+		return borrow;
+	}
+
+	short cmp_n_portable(const limb_t* a, const limb_t* b, std::size_t length)
+	{
+		for (std::size_t i = length; i-- > 0;) {
+			if (a[i] == b[i])
+				continue;
+
+			return a[i] < b[i] ? CMP_SECOND_PARAMETER_BIGGER : CMP_SECOND_PARAMETER_SMALLER;
+		}
+
+		return CMP_EQUAL;
+	}
+
+	limb_t mul_add_small_n_portable(limb_t* limbs, std::size_t length, limb_t factor, limb_t carry)
+	{
+		double_limb_t product_carry = carry;
+		for (std::size_t i = 0; i < length; i++) {
+			double_limb_t product = static_cast<double_limb_t>(limbs[i]) * factor + product_carry;
+			limbs[i] = static_cast<limb_t>(product);
+			product_carry = product >> BigInt::LIMB_BITS;
+		}
+
+		return static_cast<limb_t>(product_carry);
+	}
+
+	// below this length the vector kernels are not worth the dispatch
+	const std::size_t SIMD_MIN_LENGTH = 16;
+
+	static limb_t add_n(limb_t* destination, const limb_t* a, const limb_t* b, std::size_t length, limb_t carry)
+	{
+#if defined(BIGINT_X86_SIMD)
+		if (length >= SIMD_MIN_LENGTH) {
+			switch (active_simd_level()) {
+				case BigInt::SIMD_AVX512:
+					return add_n_avx512(destination, a, b, length, carry);
+				case BigInt::SIMD_AVX2:
+					return add_n_avx2(destination, a, b, length, carry);
+				default:
+					break;
+			}
+		}
+#endif
+		return add_n_portable(destination, a, b, length, carry);
+	}
+
+	static limb_t sub_n(limb_t* destination, const limb_t* a, const limb_t* b, std::size_t length, limb_t borrow)
+	{
+#if defined(BIGINT_X86_SIMD)
+		if (length >= SIMD_MIN_LENGTH) {
+			switch (active_simd_level()) {
+				case BigInt::SIMD_AVX512:
+					return sub_n_avx512(destination, a, b, length, borrow);
+				case BigInt::SIMD_AVX2:
+					return sub_n_avx2(destination, a, b, length, borrow);
+				default:
+					break;
+			}
+		}
+#endif
+		return sub_n_portable(destination, a, b, length, borrow);
+	}
+
+	static short cmp_n(const limb_t* a, const limb_t* b, std::size_t length)
+	{
+#if defined(BIGINT_X86_SIMD)
+		if (length >= SIMD_MIN_LENGTH) {
+			switch (active_simd_level()) {
+				case BigInt::SIMD_AVX512:
+					return cmp_n_avx512(a, b, length);
+				case BigInt::SIMD_AVX2:
+					return cmp_n_avx2(a, b, length);
+				default:
+					break;
+			}
+		}
+#endif
+		return cmp_n_portable(a, b, length);
+	}
+
+	static limb_t mul_add_small_n(limb_t* limbs, std::size_t length, limb_t factor, limb_t carry)
+	{
+#if defined(BIGINT_X86_SIMD)
+		if (length >= SIMD_MIN_LENGTH) {
+			switch (active_simd_level()) {
+				case BigInt::SIMD_AVX512:
+					return mul_add_small_n_avx512(limbs, length, factor, carry);
+				case BigInt::SIMD_AVX2:
+					return mul_add_small_n_avx2(limbs, length, factor, carry);
+				default:
+					break;
+			}
+		}
+#endif
+		return mul_add_small_n_portable(limbs, length, factor, carry);
+	}
+
+	// -----------------------
+	// -- Internal Util functions
+	// -----------------------
+
+	// adds carry to the limbs, stops as soon as nothing is left to carry
+	static limb_t add_carry(limb_t* limbs, std::size_t length, limb_t carry)
+	{
+		for (std::size_t i = 0; i < length && carry != 0; i++) {
+			limbs[i] += carry;
+			carry = limbs[i] < carry;
+		}
+
+		return carry;
+	}
+
+	// subtracts borrow from the limbs, stops as soon as nothing is left to borrow
+	static limb_t sub_borrow(limb_t* limbs, std::size_t length, limb_t borrow)
+	{
+		for (std::size_t i = 0; i < length && borrow != 0; i++) {
+			limb_t limb = limbs[i];
+			limbs[i] = limb - borrow;
+			borrow = limb < borrow;
+		}
+
+		return borrow;
+	}
+
+	// -----------------------
+	// -- Arithmetic
+	// -----------------------
+
+	short cmp(const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length)
+	{
+		if (a_length != b_length)
+			return a_length > b_length ? CMP_SECOND_PARAMETER_SMALLER : CMP_SECOND_PARAMETER_BIGGER;
+
+		return cmp_n(a, b, a_length);
+	}
+
+	limb_t add(limb_t* destination, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length)
+	{
+		double_limb_t carry = add_n(destination, a, b, b_length, 0);
+
+		// only the carry is left to propagate
+		for (std::size_t i = b_length; i < a_length; i++) {
+			double_limb_t current = static_cast<double_limb_t>(a[i]) + carry;
+			destination[i] = static_cast<limb_t>(current);
+			carry = current >> BigInt::LIMB_BITS;
+		}
+
+		return static_cast<limb_t>(carry);
+	}
+
+	limb_t sub(limb_t* destination, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length)
+	{
+		limb_t borrow = sub_n(destination, a, b, b_length, 0);
+
+		// only the borrow is left to propagate
+		for (std::size_t i = b_length; i < a_length; i++) {
+			bool is_diff_negative = a[i] < borrow;
+			destination[i] = a[i] - borrow;
+			borrow = is_diff_negative;
+		}
+
+		return borrow;
+	}
+
+	limb_t mul_add_small(limb_t* limbs, std::size_t length, limb_t factor, limb_t addend)
+	{
+		return mul_add_small_n(limbs, length, factor, addend);
+	}
+
+	limb_t addmul_small(limb_t* destination, const limb_t* a, std::size_t length, limb_t factor)
+	{
+		double_limb_t carry = 0;
+		for (std::size_t i = 0; i < length; i++) {
+			// cannot overflow: (2^32 - 1)^2 + 2 * (2^32 - 1) = 2^64 - 1
+			double_limb_t current = static_cast<double_limb_t>(a[i]) * factor + destination[i] + carry;
+			destination[i] = static_cast<limb_t>(current);
+			carry = current >> BigInt::LIMB_BITS;
+		}
+
+		return static_cast<limb_t>(carry);
+	}
+
+	limb_t submul_small(limb_t* destination, const limb_t* a, std::size_t length, limb_t factor)
+	{
+		limb_t borrow = 0;
+		for (std::size_t i = 0; i < length; i++) {
+			// the high half is at most 2^32 - 2, so the borrow of the subtraction still fits
+			double_limb_t product = static_cast<double_limb_t>(a[i]) * factor + borrow;
+			limb_t low = static_cast<limb_t>(product);
+			borrow = static_cast<limb_t>(product >> BigInt::LIMB_BITS) + (destination[i] < low);
+			destination[i] -= low;
+		}
+
+		return borrow;
+	}
+
+	limb_t addmul(limb_t* destination, std::size_t destination_length, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length)
+	{
+		assert(destination_length >= a_length + b_length);
+
+		if (a_length < b_length) {
+			std::swap(a, b);
+			std::swap(a_length, b_length);
+		}
+
+		// one row per limb of b like the schoolbook multiplication, but added to destination
+		if (b_length < BigInt::karatsuba_threshold) {
+			limb_t carry = 0;
+			for (std::size_t i = 0; i < b_length; i++) {
+				limb_t row_carry = addmul_small(destination + i, a, a_length, b[i]);
+				carry += add_carry(destination + i + a_length, destination_length - i - a_length, row_carry);
+			}
+			return carry;
+		}
+
+		limb_vector product(a_length + b_length);
+		mul(product.data(), a, a_length, b, b_length);
+		return add(destination, destination, destination_length, product.data(), product.size());
+	}
+
+	limb_t submul(limb_t* destination, std::size_t destination_length, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length)
+	{
+		assert(destination_length >= a_length + b_length);
+
+		if (a_length < b_length) {
+			std::swap(a, b);
+			std::swap(a_length, b_length);
+		}
+
+		if (b_length < BigInt::karatsuba_threshold) {
+			limb_t borrow = 0;
+			for (std::size_t i = 0; i < b_length; i++) {
+				limb_t row_borrow = submul_small(destination + i, a, a_length, b[i]);
+				borrow += sub_borrow(destination + i + a_length, destination_length - i - a_length, row_borrow);
+			}
+			return borrow;
+		}
+
+		limb_vector product(a_length + b_length);
+		mul(product.data(), a, a_length, b, b_length);
+		return sub(destination, destination, destination_length, product.data(), product.size());
+	}
+
+	limb_t div_small(limb_t* limbs, std::size_t length, limb_t divisor)
+	{
+		double_limb_t remainder = 0;
+		for (std::size_t i = length; i-- > 0;) {
+			double_limb_t current = (remainder << BigInt::LIMB_BITS) | limbs[i];
+			limbs[i] = static_cast<limb_t>(current / divisor);
+			remainder = current % divisor;
+		}
+
+		return static_cast<limb_t>(remainder);
+	}
+}
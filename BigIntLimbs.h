@@ -0,0 +1,314 @@
+#pragma once
+
+#include "BigInt.h"
+#include "BigIntStats.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BIGINT_X86_SIMD
+#endif
+
+// -----------------------
+// -- Low level routines on raw limb arrays
+// -----------------------
+// All arrays are stored least significant limb first. Unless stated otherwise
+// the inputs may contain leading zero limbs and the destination has to be big
+// enough for the full result.
+
+namespace bigint_limbs
+{
+	typedef BigInt::limb_t limb_t;
+	typedef BigInt::double_limb_t double_limb_t;
+
+	const short CMP_SECOND_PARAMETER_SMALLER = -1;
+	const short CMP_SECOND_PARAMETER_BIGGER = 1;
+	const short CMP_EQUAL = 0;
+
+	// biggest power of ten fitting into one limb, decimal conversion works on chunks of this size
+	const limb_t DECIMAL_CHUNK_BASE = 1000000000;
+	const int DECIMAL_CHUNK_DIGITS = 9;
+
+	// -----------------------
+	// -- Instrumentation
+	// -----------------------
+
+#if defined(BIGINT_STATS)
+	// counts one call of operation on the calling thread and times it until the end of the scope
+	// allocations while the scope is alive are charged to it, an inner scope takes over until it ends
+	class StatsScope
+	{
+		public:
+			StatsScope(BigIntStats::Operation operation, std::size_t limbs);
+			~StatsScope();
+
+			StatsScope(const StatsScope&) = delete;
+			StatsScope& operator=(const StatsScope&) = delete;
+
+		private:
+			BigIntStats::Operation operation;
+			BigIntStats::Operation previous;
+			std::chrono::steady_clock::time_point start;
+	};
+
+	// charges an allocation to the innermost scope of the calling thread, or to OP_OTHER
+	void count_allocation(std::size_t bytes);
+
+#define BIGINT_STATS_SCOPE(operation, limbs) bigint_limbs::StatsScope bigint_stats_scope(BigIntStats::operation, limbs)
+#define BIGINT_STATS_ALLOCATION(bytes) bigint_limbs::count_allocation(bytes)
+#else
+#define BIGINT_STATS_SCOPE(operation, limbs) ((void)0)
+#define BIGINT_STATS_ALLOCATION(bytes) ((void)0)
+#endif
+
+	// stateless allocator for the scratch buffers of the algorithms
+	// allocates from BigInt::default_resource() of the calling thread, so a scratch buffer
+	// has to be released by the thread that allocated it and must not outlive the operation
+	template <typename T>
+	struct ScratchAllocator
+	{
+		typedef T value_type;
+
+		ScratchAllocator() = default;
+		template <typename U>
+		ScratchAllocator(const ScratchAllocator<U>&) {}
+
+		T* allocate(std::size_t count)
+		{
+			BIGINT_STATS_ALLOCATION(sizeof(T) * count);
+			return static_cast<T*>(BigInt::default_resource()->allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		void deallocate(T* pointer, std::size_t count) { BigInt::default_resource()->deallocate(pointer, sizeof(T) * count, alignof(T)); }
+	};
+
+	template <typename T, typename U>
+	bool operator==(const ScratchAllocator<T>&, const ScratchAllocator<U>&) { return true; }
+	template <typename T, typename U>
+	bool operator!=(const ScratchAllocator<T>&, const ScratchAllocator<U>&) { return false; }
+
+	template <typename T>
+	using scratch_vector = std::vector<T, ScratchAllocator<T>>;
+	typedef scratch_vector<limb_t> limb_vector;
+
+	// -----------------------
+	// -- Parallel tasks
+	// -----------------------
+
+	class ThreadPool;
+
+	// true if a multiplication with operands of length limbs should spread its sub-products over the threads
+	bool use_parallel(std::size_t length);
+
+	// independent tasks on a shared work stealing pool of BigInt::thread_count - 1 worker threads
+	// tasks may start groups of their own, wait() runs queued tasks on the calling thread until the group is done
+	// a scratch buffer has to be released by the thread that allocated it, so the caller allocates
+	// the buffers for the results and the tasks only write into them
+	class TaskGroup
+	{
+		public:
+			TaskGroup();
+			// waits for the tasks, call wait() before to get their exceptions
+			~TaskGroup();
+
+			TaskGroup(const TaskGroup&) = delete;
+			TaskGroup& operator=(const TaskGroup&) = delete;
+
+			void run(std::function<void()> task);
+
+			// rethrows the first exception of a task
+			void wait();
+
+			// called by the pool after a task of the group ran
+			void finish(std::exception_ptr task_error);
+
+		private:
+			std::shared_ptr<ThreadPool> pool;
+			std::atomic<std::size_t> pending;
+			std::mutex error_mutex;
+			std::exception_ptr error;
+
+			void wait_for_tasks();
+	};
+
+	// -----------------------
+	// -- Basic kernels
+	// -----------------------
+	// the loops under add, sub, cmp and mul_add_small, both operands have length limbs
+	// the portable versions run everywhere, the vector versions only if active_simd_level() allows them
+
+	// min(BigInt::simd_level, instruction set of the cpu)
+	BigInt::SimdLevel active_simd_level();
+
+	limb_t add_n_portable(limb_t* destination, const limb_t* a, const limb_t* b, std::size_t length, limb_t carry);
+	limb_t sub_n_portable(limb_t* destination, const limb_t* a, const limb_t* b, std::size_t length, limb_t borrow);
+	short cmp_n_portable(const limb_t* a, const limb_t* b, std::size_t length);
+	limb_t mul_add_small_n_portable(limb_t* limbs, std::size_t length, limb_t factor, limb_t carry);
+
+#if defined(BIGINT_X86_SIMD)
+	limb_t add_n_avx2(limb_t* destination, const limb_t* a, const limb_t* b, std::size_t length, limb_t carry);
+	limb_t sub_n_avx2(limb_t* destination, const limb_t* a, const limb_t* b, std::size_t length, limb_t borrow);
+	short cmp_n_avx2(const limb_t* a, const limb_t* b, std::size_t length);
+	limb_t mul_add_small_n_avx2(limb_t* limbs, std::size_t length, limb_t factor, limb_t carry);
+
+	limb_t add_n_avx512(limb_t* destination, const limb_t* a, const limb_t* b, std::size_t length, limb_t carry);
+	limb_t sub_n_avx512(limb_t* destination, const limb_t* a, const limb_t* b, std::size_t length, limb_t borrow);
+	short cmp_n_avx512(const limb_t* a, const limb_t* b, std::size_t length);
+	limb_t mul_add_small_n_avx512(limb_t* limbs, std::size_t length, limb_t factor, limb_t carry);
+#endif
+
+	// -----------------------
+	// -- Arithmetic
+	// -----------------------
+
+	// returns the length without leading zero limbs
+	std::size_t trimmed_length(const limb_t* a, std::size_t length);
+
+	// compares two limb arrays without leading zeros
+	// returns number > 0 if b is bigger
+	// returns number < 0 if b is smaller
+	// returns 0 if numbers are equals
+	short cmp(const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length);
+
+	// destination = a + b, a_length has to be >= b_length
+	// destination needs a_length limbs and may be the same array as a
+	// returns the carry out of the most significant limb
+	limb_t add(limb_t* destination, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length);
+
+	// destination = a - b, a_length has to be >= b_length
+	// destination needs a_length limbs and may be the same array as a
+	// returns the borrow out of the most significant limb
+	limb_t sub(limb_t* destination, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length);
+
+	// multiplies the limbs in place with factor and adds addend
+	// returns the carry which did not fit into length limbs
+	limb_t mul_add_small(limb_t* limbs, std::size_t length, limb_t factor, limb_t addend);
+
+	// destination += a * factor, returns the carry which did not fit into length limbs
+	limb_t addmul_small(limb_t* destination, const limb_t* a, std::size_t length, limb_t factor);
+	// destination -= a * factor, returns the borrow out of length limbs
+	limb_t submul_small(limb_t* destination, const limb_t* a, std::size_t length, limb_t factor);
+
+	// destination += a * b, destination needs at least a_length + b_length limbs and must not overlap a or b
+	// short operands are multiplied straight into destination, returns the carry out of destination_length limbs
+	limb_t addmul(limb_t* destination, std::size_t destination_length, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length);
+	// destination -= a * b, same contract as addmul, returns the borrow out of destination_length limbs
+	limb_t submul(limb_t* destination, std::size_t destination_length, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length);
+
+	// divides the limbs in place by divisor and returns the remainder
+	limb_t div_small(limb_t* limbs, std::size_t length, limb_t divisor);
+
+	// destination = a * b, destination needs a_length + b_length limbs and must not overlap a or b
+	// picks schoolbook, karatsuba, toom-3 or ntt depending on the operand sizes
+	void mul(limb_t* destination, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length);
+
+	// O(n*m) multiplication, same contract as mul
+	void mul_schoolbook(limb_t* destination, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length);
+
+	// destination = a * a, destination needs 2 * a_length limbs and must not overlap a
+	// like mul, but every cross product a[i] * a[j] is computed once, mul calls it when both operands are the same limbs
+	void sqr(limb_t* destination, const limb_t* a, std::size_t a_length);
+
+	// same contract as mul, but all temporary limbs come from scratch, for hot loops which must not allocate
+	// schoolbook or single threaded karatsuba, scratch needs mul_scratch_length(max(a_length, b_length)) limbs
+	void mul_scratch(limb_t* destination, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length, limb_t* scratch);
+	std::size_t mul_scratch_length(std::size_t length);
+
+	// O(n^2 / 2) squaring, same contract as sqr
+	void sqr_schoolbook(limb_t* destination, const limb_t* a, std::size_t a_length);
+
+	// O(n log n) multiplication with a three prime number theoretic transform, same contract as mul
+	// a_length + b_length must not exceed ntt_max_product_length()
+	void mul_ntt(limb_t* destination, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length);
+	std::size_t ntt_max_product_length();
+
+	// quotient = a / b, remainder = a % b with b_length > 0, no leading zero in b and a_length >= b_length
+	// quotient needs a_length - b_length + 1 limbs, remainder needs b_length limbs
+	// picks knuth's long division or newton reciprocal division depending on the operand sizes
+	void divmod(limb_t* quotient, limb_t* remainder, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length);
+
+	// for repeated newton divisions by the same b, which only pay for the reciprocal once
+	// shift = normalization_shift(b), v = b << shift has its highest bit set and x = reciprocal(v)
+	unsigned normalization_shift(const limb_t* b, std::size_t b_length);
+	// floor(B^(2n) / v) for a normalized v of n >= 2 limbs, the result has n + 1 limbs
+	limb_vector reciprocal(const limb_t* v, std::size_t v_length);
+	// same contract as divmod, v has to be the normalized b of v_length limbs with its reciprocal x
+	void divmod_preinverted(limb_t* quotient, limb_t* remainder, const limb_t* a, std::size_t a_length, const limb_t* v, std::size_t v_length, unsigned shift, const limb_t* x);
+
+	// -----------------------
+	// -- Bits
+	// -----------------------
+
+	// number of bits without the leading zeros, 0 for zero
+	std::size_t bit_length(const limb_t* a, std::size_t length);
+
+	// number of zero bits below the lowest set bit, a must not be zero
+	std::size_t trailing_zero_bits(const limb_t* a, std::size_t length);
+
+	// number of set bits
+	std::size_t popcount(const limb_t* a, std::size_t length);
+
+	// destination = a << shift with shift < LIMB_BITS, returns the bits shifted out of the top limb
+	// destination needs length limbs and may overlap a if it does not start below it, e.g. a + limb_shift
+	limb_t shift_left(limb_t* destination, const limb_t* a, std::size_t length, unsigned shift);
+
+	// destination = a >> shift with shift < LIMB_BITS, the bits shifted out of the bottom are dropped
+	// destination needs length limbs and may overlap a if it does not start above it
+	void shift_right(limb_t* destination, const limb_t* a, std::size_t length, unsigned shift);
+
+	enum BitwiseOperation : unsigned char { BITWISE_AND, BITWISE_OR, BITWISE_XOR };
+
+	// destination = a op b on the infinite two's complement of both signed operands, in one pass without copies
+	// destination gets the magnitude of the result in max(a_length, b_length) + 1 limbs and may be the same array as a or b
+	// returns true if the result is negative
+	bool bitwise(limb_t* destination, const limb_t* a, std::size_t a_length, bool a_is_negative, const limb_t* b, std::size_t b_length, bool b_is_negative, BitwiseOperation operation);
+
+	// -----------------------
+	// -- Powers
+	// -----------------------
+
+	// number of limbs pow needs for a^exponent, more than BigInt::MAX_LIMBS if it would not fit into a BigInt
+	std::size_t power_length(const limb_t* a, std::size_t a_length, std::uint64_t exponent);
+
+	// destination = a^exponent, destination needs power_length() limbs and must not overlap a
+	// the factors of two in a are shifted in at the end, one limb powers of ten are taken from power_of_ten
+	void pow(limb_t* destination, const limb_t* a, std::size_t a_length, std::uint64_t exponent);
+
+	// number of limbs power_of_ten needs for 10^exponent, more than BigInt::MAX_LIMBS if it would not fit into a BigInt
+	std::size_t power_of_ten_length(std::uint64_t exponent);
+
+	// writes 10^exponent without leading zeros and returns its length, destination needs power_of_ten_length() limbs
+	// small exponents are copied from a cache, bigger ones are multiplied from it and the decimal power levels
+	std::size_t power_of_ten(limb_t* destination, std::uint64_t exponent);
+
+	// DECIMAL_CHUNK_BASE^(2^level), the reciprocal for newton division is only added when a conversion needs it
+	struct DecimalPower
+	{
+		std::vector<limb_t> power;
+		unsigned shift = 0;
+		std::vector<limb_t> normalized;
+		std::vector<limb_t> reciprocal;
+	};
+
+	// the levels are computed once and shared by all threads, the reference stays valid until the program ends
+	const DecimalPower& decimal_power(std::size_t level, bool with_reciprocal = false);
+
+	// splits a into chunks of DECIMAL_CHUNK_DIGITS decimal digits, least significant chunk first
+	// the result has no leading zero chunks, big numbers are split by divide and conquer
+	limb_vector to_decimal_chunks(const limb_t* a, std::size_t a_length);
+
+	// number of limbs from_decimal_chunks needs for chunk_count chunks
+	std::size_t limbs_for_decimal_chunks(std::size_t chunk_count);
+
+	// converts chunks of DECIMAL_CHUNK_DIGITS decimal digits (least significant first) back to limbs
+	// destination needs limbs_for_decimal_chunks(chunk_count) limbs, returns the length without leading zeros
+	std::size_t from_decimal_chunks(limb_t* destination, const limb_t* chunks, std::size_t chunk_count);
+}
@@ -0,0 +1,384 @@
+#include "BigIntMod.h"
+#include "BigIntLimbs.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace bigint_limbs;
+
+// -----------------------
+// -- Internal Util functions
+// -----------------------
+
+// bit index of an exponent, bit 0 is the lowest bit of limb 0
+static bool test_bit(const limb_t* a, std::size_t bit)
+{
+	return (a[bit / BigInt::LIMB_BITS] >> (bit % BigInt::LIMB_BITS)) & 1;
+}
+
+// packs the limbs into wider words, lowest limb first, limbs needs word_count * sizeof(Word) / sizeof(limb_t) limbs
+template <typename Word>
+static void to_words(Word* words, const limb_t* limbs, std::size_t word_count)
+{
+	const std::size_t limbs_per_word = sizeof(Word) / sizeof(limb_t);
+	for (std::size_t i = 0; i < word_count; i++) {
+		Word word = 0;
+		for (std::size_t j = 0; j < limbs_per_word; j++)
+			word |= static_cast<Word>(limbs[i * limbs_per_word + j]) << (BigInt::LIMB_BITS * j);
+		words[i] = word;
+	}
+}
+
+template <typename Word>
+static void from_words(limb_t* limbs, const Word* words, std::size_t word_count)
+{
+	const std::size_t limbs_per_word = sizeof(Word) / sizeof(limb_t);
+	for (std::size_t i = 0; i < word_count; i++) {
+		for (std::size_t j = 0; j < limbs_per_word; j++)
+			limbs[i * limbs_per_word + j] = static_cast<limb_t>(words[i] >> (BigInt::LIMB_BITS * j));
+	}
+}
+
+// window size of the sliding window exponentiation for an exponent of bit_count bits
+// bigger windows need fewer multiplications but a table of 2^(window - 1) odd powers
+static unsigned window_bits(std::size_t bit_count)
+{
+	const std::size_t limits[] = { 24, 80, 240, 672, 1792 };
+	unsigned window = 1;
+	for (std::size_t limit : limits) {
+		if (bit_count <= limit)
+			break;
+		window++;
+	}
+
+	return window;
+}
+
+// result = result * table[0]^exponent with multiply(destination, a, b), all values have size words
+// table has room for the odd powers table[0]^1, table[0]^3, ..., table[0]^(2^window - 1), temporary for one value
+// left to right, every window starts and ends with a one bit and the zeros between windows are single squarings
+template <typename Word, typename Multiply>
+static void sliding_window(Word* result, Word* table, Word* temporary, std::size_t size, const limb_t* exponent, std::size_t bit_count, unsigned window, Multiply multiply)
+{
+	std::size_t table_size = std::size_t(1) << (window - 1);
+	multiply(temporary, table, table);
+	for (std::size_t i = 1; i < table_size; i++)
+		multiply(table + i * size, table + (i - 1) * size, temporary);
+
+	// result is the one of the representation at the beginning, the first window copies its power instead of squaring it
+	bool is_started = false;
+	for (std::size_t i = bit_count; i-- > 0;) {
+		if (!test_bit(exponent, i)) {
+			multiply(result, result, result);
+			continue;
+		}
+
+		std::size_t low = i + 1 >= window ? i + 1 - window : 0;
+		while (!test_bit(exponent, low))
+			low++;
+
+		std::size_t value = 0;
+		for (std::size_t j = i + 1; j-- > low;) {
+			value = (value << 1) | test_bit(exponent, j);
+			if (is_started)
+				multiply(result, result, result);
+		}
+
+		const Word* power = table + (value / 2) * size;
+		if (is_started)
+			multiply(result, result, power);
+		else
+			std::copy(power, power + size, result);
+		is_started = true;
+		i = low;
+	}
+}
+
+// limbs for the operands and the scratch of single products, kept by the calling thread and only grown
+// a plain vector and not a scratch_vector, it outlives any ResourceScope of the thread
+static limb_t* thread_scratch(std::size_t length)
+{
+	static thread_local std::vector<limb_t> scratch;
+	if (scratch.size() < length)
+		scratch.resize(length);
+	return scratch.data();
+}
+
+// -----------------------
+// -- Constructor
+// -----------------------
+
+BigIntModContext::BigIntModContext(const BigInt& modulus) : modulus(modulus), n(modulus.length), is_montgomery(false), word_count(0), modulus_inverse(0)
+{
+	assert(!modulus.is_negative && modulus > 1);
+
+	const limb_t* m = this->modulus.limbs;
+
+	// floor(B^(2n) / m), the modulus has no leading zero limb, so this is at most B^(2n) / B^(n - 1) = B^(n + 1)
+	// only a modulus of exactly B^(n - 1) needs the limb n + 1
+	limb_vector power(2 * n + 1, 0);
+	power[2 * n] = 1;
+	limb_vector quotient(n + 2);
+	limb_vector remainder(n);
+	divmod(quotient.data(), remainder.data(), power.data(), power.size(), m, n);
+	barrett_factor.assign(quotient.begin(), quotient.begin() + trimmed_length(quotient.data(), n + 2));
+
+	is_montgomery = (m[0] & 1) != 0;
+	if (!is_montgomery)
+		return;
+
+	// R^2 = B^(2 * padded_length) where the modulus is padded to whole words
+	word_count = (n + LIMBS_PER_WORD - 1) / LIMBS_PER_WORD;
+	std::size_t padded_length = word_count * LIMBS_PER_WORD;
+	power.assign(2 * padded_length + 1, 0);
+	power[2 * padded_length] = 1;
+	quotient.resize(2 * padded_length - n + 2);
+	divmod(quotient.data(), remainder.data(), power.data(), power.size(), m, n);
+
+	limb_vector padded(padded_length, 0);
+	std::copy(remainder.begin(), remainder.end(), padded.begin());
+	r_squared.resize(word_count);
+	to_words(r_squared.data(), padded.data(), word_count);
+
+	std::copy(m, m + n, padded.begin());
+	modulus_words.resize(word_count);
+	to_words(modulus_words.data(), padded.data(), word_count);
+
+	// newton iteration for the inverse modulo the word size, every step doubles the number of correct bits
+	word_t inverse = modulus_words[0];
+	for (int i = 0; i < 5; i++)
+		inverse *= 2 - modulus_words[0] * inverse;
+	modulus_inverse = 0 - inverse;
+}
+
+// -----------------------
+// -- Reduction
+// -----------------------
+
+void BigIntModContext::load(limb_t* destination, const BigInt& a) const
+{
+	std::fill(destination, destination + n, 0);
+
+	if (!a.is_negative && cmp(a.limbs, a.length, modulus.limbs, n) == CMP_SECOND_PARAMETER_BIGGER) {
+		std::copy(a.limbs, a.limbs + a.length, destination);
+		return;
+	}
+
+	if (a.length >= n) {
+		limb_vector quotient(a.length - n + 1);
+		divmod(quotient.data(), destination, a.limbs, a.length, modulus.limbs, n);
+	}
+	else {
+		std::copy(a.limbs, a.limbs + a.length, destination);
+	}
+
+	// -a mod m = m - (a mod m) for a remainder above zero
+	if (a.is_negative && trimmed_length(destination, n) > 0)
+		sub(destination, modulus.limbs, n, destination, n);
+}
+
+BigInt BigIntModContext::store(const limb_t* a) const
+{
+	BigInt result(n, false, BigInt::default_resource());
+	std::copy(a, a + n, result.limbs);
+	result.normalize();
+	return result;
+}
+
+void BigIntModContext::store(const limb_t* a, BigInt& result) const
+{
+	// the old value is not needed, so nothing is copied when the buffer grows
+	result.length = 0;
+	result.ensure_capacity(n);
+	std::copy(a, a + n, result.limbs);
+	result.length = n;
+	result.is_negative = false;
+	result.normalize();
+}
+
+BigInt BigIntModContext::reduce(const BigInt& a) const
+{
+	limb_vector value(n);
+	load(value.data(), a);
+	return store(value.data());
+}
+
+// -----------------------
+// -- Multiplication
+// -----------------------
+
+void BigIntModContext::montgomery_mul(word_t* destination, const word_t* a, const word_t* b, word_t* scratch) const
+{
+	// coarsely integrated operand scanning: adds a * b[i] and removes the lowest word with a multiple of the modulus
+	// t stays below 2 * modulus, so it fits into word_count + 1 words plus one word for the carry in between
+	const unsigned word_bits = 8 * sizeof(word_t);
+	const std::size_t w = word_count;
+	const word_t* m = modulus_words.data();
+	word_t* t = scratch;
+	std::fill(t, t + w + 2, 0);
+
+	for (std::size_t i = 0; i < w; i++) {
+		double_word_t carry = 0;
+		for (std::size_t j = 0; j < w; j++) {
+			double_word_t current = static_cast<double_word_t>(a[j]) * b[i] + t[j] + carry;
+			t[j] = static_cast<word_t>(current);
+			carry = current >> word_bits;
+		}
+		double_word_t top = static_cast<double_word_t>(t[w]) + carry;
+		t[w] = static_cast<word_t>(top);
+		t[w + 1] = static_cast<word_t>(top >> word_bits);
+
+		// t + factor * m is divisible by the word size, the division is a shift by one word
+		word_t factor = t[0] * modulus_inverse;
+		carry = (static_cast<double_word_t>(factor) * m[0] + t[0]) >> word_bits;
+		for (std::size_t j = 1; j < w; j++) {
+			double_word_t current = static_cast<double_word_t>(factor) * m[j] + t[j] + carry;
+			t[j - 1] = static_cast<word_t>(current);
+			carry = current >> word_bits;
+		}
+		top = static_cast<double_word_t>(t[w]) + carry;
+		t[w - 1] = static_cast<word_t>(top);
+		t[w] = t[w + 1] + static_cast<word_t>(top >> word_bits);
+	}
+
+	// t < 2m, subtract m once if t >= m
+	bool is_reduced = t[w] == 0;
+	if (is_reduced) {
+		std::size_t j = w;
+		while (j > 0 && t[j - 1] == m[j - 1])
+			j--;
+		is_reduced = j > 0 && t[j - 1] < m[j - 1];
+	}
+	if (!is_reduced) {
+		word_t borrow = 0;
+		for (std::size_t j = 0; j < w; j++) {
+			word_t difference = t[j] - m[j] - borrow;
+			borrow = t[j] < m[j] || (t[j] == m[j] && borrow != 0);
+			t[j] = difference;
+		}
+	}
+
+	std::copy(t, t + w, destination);
+}
+
+std::size_t BigIntModContext::barrett_scratch_length() const
+{
+	// x, the estimate and its product with the modulus, then the scratch of the longest product
+	return 6 * n + 4 + mul_scratch_length(n + 2);
+}
+
+void BigIntModContext::barrett_mul(limb_t* destination, const limb_t* a, const limb_t* b, limb_t* scratch) const
+{
+	// x = a * b < m^2, q = floor(floor(x / B^(n - 1)) * factor / B^(n + 1)) is at most two below floor(x / m)
+	limb_t* x = scratch;
+	limb_t* estimate = x + 2 * n;
+	limb_t* estimate_times_m = estimate + 2 * n + 3;
+	limb_t* product_scratch = estimate_times_m + 2 * n + 1;
+
+	// all three products have fixed lengths, so they take their temporary limbs from the scratch as well
+	mul_scratch(x, a, n, b, n, product_scratch);
+	mul_scratch(estimate, x + n - 1, n + 1, barrett_factor.data(), barrett_factor.size(), product_scratch);
+	// q is below x / m < m, its limbs above n + 1 are zero
+	const limb_t* q = estimate + n + 1;
+	mul_scratch(estimate_times_m, q, n + 1, modulus.limbs, n, product_scratch);
+
+	// the remainder is below 3m < B^(n + 1), so the lower n + 1 limbs are enough and the borrow is dropped
+	sub(x, x, n + 1, estimate_times_m, n + 1);
+	while (x[n] != 0 || cmp_n_portable(x, modulus.limbs, n) != CMP_SECOND_PARAMETER_BIGGER)
+		sub(x, x, n + 1, modulus.limbs, n);
+
+	std::copy(x, x + n, destination);
+}
+
+BigInt BigIntModContext::mul(const BigInt& a, const BigInt& b) const
+{
+	BigInt result(0);
+	mul(a, b, result);
+	return result;
+}
+
+BigInt BigIntModContext::square(const BigInt& a) const
+{
+	BigInt result(0);
+	square(a, result);
+	return result;
+}
+
+void BigIntModContext::mul(const BigInt& a, const BigInt& b, BigInt& result) const
+{
+	limb_t* values = thread_scratch(2 * n + barrett_scratch_length());
+	load(values, a);
+	load(values + n, b);
+	barrett_mul(values, values, values + n, values + 2 * n);
+	store(values, result);
+}
+
+void BigIntModContext::square(const BigInt& a, BigInt& result) const
+{
+	limb_t* value = thread_scratch(n + barrett_scratch_length());
+	load(value, a);
+	barrett_mul(value, value, value, value + n);
+	store(value, result);
+}
+
+// -----------------------
+// -- Exponentiation
+// -----------------------
+
+BigInt BigIntModContext::pow(const BigInt& base, const BigInt& exponent) const
+{
+	assert(!exponent.is_negative);
+
+	return is_montgomery ? pow_montgomery(base, exponent) : pow_barrett(base, exponent);
+}
+
+BigInt BigIntModContext::pow_montgomery(const BigInt& base, const BigInt& exponent) const
+{
+	std::size_t bit_count = bit_length(exponent.limbs, exponent.length);
+	unsigned window = window_bits(bit_count);
+	std::size_t w = word_count;
+
+	scratch_vector<word_t> table((std::size_t(1) << (window - 1)) * w);
+	scratch_vector<word_t> result(w);
+	scratch_vector<word_t> one(w, 0);
+	scratch_vector<word_t> scratch(w + 2);
+	limb_vector limbs(w * LIMBS_PER_WORD, 0);
+	auto multiply = [&](word_t* destination, const word_t* a, const word_t* b) { montgomery_mul(destination, a, b, scratch.data()); };
+
+	// every value is kept multiplied with R, a multiplication with R^2 converts into this form and one with 1 back
+	load(limbs.data(), base);
+	to_words(table.data(), limbs.data(), w);
+	one[0] = 1;
+	multiply(table.data(), table.data(), r_squared.data());
+	multiply(result.data(), one.data(), r_squared.data());
+
+	sliding_window(result.data(), table.data(), one.data(), w, exponent.limbs, bit_count, window, multiply);
+
+	std::fill(one.begin(), one.end(), 0);
+	one[0] = 1;
+	multiply(result.data(), result.data(), one.data());
+	from_words(limbs.data(), result.data(), w);
+	return store(limbs.data());
+}
+
+BigInt BigIntModContext::pow_barrett(const BigInt& base, const BigInt& exponent) const
+{
+	std::size_t bit_count = bit_length(exponent.limbs, exponent.length);
+	unsigned window = window_bits(bit_count);
+
+	limb_vector table((std::size_t(1) << (window - 1)) * n);
+	limb_vector result(n, 0);
+	limb_vector temporary(n);
+	limb_vector scratch(barrett_scratch_length());
+	auto multiply = [&](limb_t* destination, const limb_t* a, const limb_t* b) { barrett_mul(destination, a, b, scratch.data()); };
+
+	load(table.data(), base);
+	result[0] = 1;
+	sliding_window(result.data(), table.data(), temporary.data(), n, exponent.limbs, bit_count, window, multiply);
+	return store(result.data());
+}
+
+BigInt pow_mod(const BigInt& base, const BigInt& exponent, const BigInt& modulus)
+{
+	return BigIntModContext(modulus).pow(base, exponent);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "BigInt.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// modular arithmetic for one fixed modulus, the constants for it are computed once by the constructor
+// single products are reduced with barrett's method, pow() works in montgomery form if the modulus is odd
+// the results are always in [0, modulus), negative operands are reduced first
+class BigIntModContext
+{
+	public:
+		typedef BigInt::limb_t limb_t;
+
+		// the modulus has to be bigger than 1
+		explicit BigIntModContext(const BigInt& modulus);
+
+		const BigInt& get_modulus() const { return modulus; }
+
+		// a mod modulus
+		BigInt reduce(const BigInt& a) const;
+
+		// a * b mod modulus
+		BigInt mul(const BigInt& a, const BigInt& b) const;
+		// a * a mod modulus
+		BigInt square(const BigInt& a) const;
+		// the same into result, which may be a or b, its buffer is reused so a loop over them does not allocate
+		// the temporary limbs are kept per thread and only grow for a bigger modulus
+		void mul(const BigInt& a, const BigInt& b, BigInt& result) const;
+		void square(const BigInt& a, BigInt& result) const;
+		// base^exponent mod modulus with a sliding window, exponent must not be negative
+		// all buffers are allocated before the first step
+		BigInt pow(const BigInt& base, const BigInt& exponent) const;
+
+	private:
+#if defined(__SIZEOF_INT128__)
+		// montgomery multiplication works on 64 bit words where the compiler has a 128 bit type
+		typedef std::uint64_t word_t;
+		typedef unsigned __int128 double_word_t;
+#else
+		typedef BigInt::limb_t word_t;
+		typedef BigInt::double_limb_t double_word_t;
+#endif
+		static const std::size_t LIMBS_PER_WORD = sizeof(word_t) / sizeof(limb_t);
+
+		BigInt modulus;
+		// number of limbs of the modulus, every reduced value is kept in this many limbs
+		std::size_t n;
+
+		// montgomery constants for R = 2^(bits of word_t * word_count), only used for an odd modulus
+		bool is_montgomery;
+		std::size_t word_count;
+		std::vector<word_t> modulus_words;
+		// -modulus^-1 mod 2^(bits of word_t)
+		word_t modulus_inverse;
+		// R^2 mod modulus, multiplying with it converts into montgomery form
+		std::vector<word_t> r_squared;
+
+		// barrett constant floor(B^(2n) / modulus), n + 1 limbs or n + 2 for a modulus of B^(n - 1)
+		std::vector<limb_t> barrett_factor;
+
+		// writes a mod modulus to destination as n limbs
+		void load(limb_t* destination, const BigInt& a) const;
+		// BigInt from n limbs
+		BigInt store(const limb_t* a) const;
+		// n limbs into the buffer of result
+		void store(const limb_t* a, BigInt& result) const;
+
+		// destination = a * b / R mod modulus for a, b < modulus in word_count words, needs word_count + 2 scratch words
+		// destination may be a or b
+		void montgomery_mul(word_t* destination, const word_t* a, const word_t* b, word_t* scratch) const;
+		// destination = a * b mod modulus for a, b < modulus in n limbs, needs barrett_scratch_length() scratch limbs
+		// destination may be a or b
+		void barrett_mul(limb_t* destination, const limb_t* a, const limb_t* b, limb_t* scratch) const;
+		std::size_t barrett_scratch_length() const;
+
+		BigInt pow_montgomery(const BigInt& base, const BigInt& exponent) const;
+		BigInt pow_barrett(const BigInt& base, const BigInt& exponent) const;
+};
+
+// base^exponent mod modulus, for repeated use with the same modulus keep a BigIntModContext instead
+BigInt pow_mod(const BigInt& base, const BigInt& exponent, const BigInt& modulus);
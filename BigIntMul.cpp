@@ -0,0 +1,453 @@
+#include "BigIntLimbs.h"
+
+#include <algorithm>
+#include <cassert>
+
+// -----------------------
+// -- Tunable thresholds
+// -----------------------
+
+std::size_t BigInt::karatsuba_threshold = 32;
+std::size_t BigInt::toom3_threshold = 256;
+std::size_t BigInt::karatsuba_square_threshold = 48;
+
+namespace bigint_limbs
+{
+	// -----------------------
+	// -- Internal Util functions
+	// -----------------------
+
+	// a signed number as magnitude and sign, only used for the toom-3 interpolation
+	struct SignedLimbs
+	{
+		limb_vector magnitude;
+		bool is_negative = false;
+	};
+
+	static void trim(SignedLimbs& number)
+	{
+		number.magnitude.resize(trimmed_length(number.magnitude.data(), number.magnitude.size()));
+		if (number.magnitude.empty())
+			number.is_negative = false;
+	}
+
+	// copies the limbs [offset, offset + count) of a, limbs beyond a_length are left out
+	static SignedLimbs slice(const limb_t* a, std::size_t a_length, std::size_t offset, std::size_t count)
+	{
+		SignedLimbs piece;
+		if (offset < a_length)
+			piece.magnitude.assign(a + offset, a + std::min(a_length, offset + count));
+		trim(piece);
+		return piece;
+	}
+
+	static SignedLimbs signed_add(const SignedLimbs& a, const SignedLimbs& b)
+	{
+		bool a_longer = a.magnitude.size() >= b.magnitude.size();
+		const SignedLimbs& longer = a_longer ? a : b;
+		const SignedLimbs& shorter = a_longer ? b : a;
+
+		SignedLimbs result;
+		if (a.is_negative == b.is_negative) {
+			// same sign, add the magnitudes and keep the sign
+			result.magnitude.resize(longer.magnitude.size() + 1);
+			result.magnitude.back() = add(result.magnitude.data(), longer.magnitude.data(), longer.magnitude.size(), shorter.magnitude.data(), shorter.magnitude.size());
+			result.is_negative = a.is_negative;
+		}
+		else {
+			// different signs, subtract the smaller magnitude and use the sign of the larger one
+			bool is_a_larger = cmp(a.magnitude.data(), a.magnitude.size(), b.magnitude.data(), b.magnitude.size()) != CMP_SECOND_PARAMETER_BIGGER;
+			const SignedLimbs& larger = is_a_larger ? a : b;
+			const SignedLimbs& smaller = is_a_larger ? b : a;
+			result.magnitude.resize(larger.magnitude.size());
+			sub(result.magnitude.data(), larger.magnitude.data(), larger.magnitude.size(), smaller.magnitude.data(), smaller.magnitude.size());
+			result.is_negative = larger.is_negative;
+		}
+
+		trim(result);
+		return result;
+	}
+
+	static SignedLimbs signed_sub(const SignedLimbs& a, SignedLimbs b)
+	{
+		b.is_negative = !b.is_negative;
+		return signed_add(a, b);
+	}
+
+	// result needs a.magnitude.size() + b.magnitude.size() limbs, so it can be filled by another thread
+	static void signed_mul(SignedLimbs& result, const SignedLimbs& a, const SignedLimbs& b)
+	{
+		mul(result.magnitude.data(), a.magnitude.data(), a.magnitude.size(), b.magnitude.data(), b.magnitude.size());
+		result.is_negative = a.is_negative != b.is_negative;
+		trim(result);
+	}
+
+	static void signed_mul_small(SignedLimbs& a, limb_t factor)
+	{
+		limb_t carry = mul_add_small(a.magnitude.data(), a.magnitude.size(), factor, 0);
+		if (carry > 0)
+			a.magnitude.push_back(carry);
+	}
+
+	// the division has to be exact, which the toom-3 interpolation guarantees
+	static void signed_div_exact_small(SignedLimbs& a, limb_t divisor)
+	{
+		limb_t remainder = div_small(a.magnitude.data(), a.magnitude.size(), divisor);
+		assert(remainder == 0);
+		(void)remainder;
+		trim(a);
+	}
+
+	// destination += value * B^offset, the sum has to fit into destination_length limbs
+	static void add_at(limb_t* destination, std::size_t destination_length, std::size_t offset, const limb_vector& value)
+	{
+		if (value.empty())
+			return;
+
+		assert(offset + value.size() <= destination_length);
+		limb_t carry = add(destination + offset, destination + offset, destination_length - offset, value.data(), value.size());
+		assert(carry == 0);
+		(void)carry;
+	}
+
+	// -----------------------
+	// -- Multiplication algorithms
+	// -----------------------
+
+	void mul_schoolbook(limb_t* destination, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length)
+	{
+		std::fill(destination, destination + a_length + b_length, 0);
+
+		for (std::size_t i = 0; i < b_length; i++) {
+			double_limb_t carry = 0;
+			for (std::size_t j = 0; j < a_length; j++) {
+				// cannot overflow: (2^32 - 1)^2 + 2 * (2^32 - 1) = 2^64 - 1
+				double_limb_t current = static_cast<double_limb_t>(b[i]) * a[j] + destination[i + j] + carry;
+				destination[i + j] = static_cast<limb_t>(current);
+				carry = current >> BigInt::LIMB_BITS;
+			}
+			destination[i + a_length] = static_cast<limb_t>(carry);
+		}
+	}
+
+	void sqr_schoolbook(limb_t* destination, const limb_t* a, std::size_t a_length)
+	{
+		std::size_t destination_length = 2 * a_length;
+		std::fill(destination, destination + destination_length, 0);
+
+		// the cross products a[i] * a[j] with i < j, each row ends one limb after the previous one
+		for (std::size_t i = 0; i + 1 < a_length; i++)
+			destination[i + a_length] = addmul_small(destination + 2 * i + 1, a + i + 1, a_length - i - 1, a[i]);
+
+		// every cross product appears twice in the square, the sum is below a^2 / 2 so no bit is lost
+		limb_t top_bit = 0;
+		for (std::size_t i = 0; i < destination_length; i++) {
+			limb_t current = destination[i];
+			destination[i] = (current << 1) | top_bit;
+			top_bit = current >> (BigInt::LIMB_BITS - 1);
+		}
+
+		// plus the squares a[i]^2 on the diagonal
+		double_limb_t carry = 0;
+		for (std::size_t i = 0; i < a_length; i++) {
+			double_limb_t square = static_cast<double_limb_t>(a[i]) * a[i];
+			double_limb_t low = static_cast<double_limb_t>(destination[2 * i]) + static_cast<limb_t>(square) + carry;
+			destination[2 * i] = static_cast<limb_t>(low);
+			double_limb_t high = static_cast<double_limb_t>(destination[2 * i + 1]) + (square >> BigInt::LIMB_BITS) + (low >> BigInt::LIMB_BITS);
+			destination[2 * i + 1] = static_cast<limb_t>(high);
+			carry = high >> BigInt::LIMB_BITS;
+		}
+
+		assert(carry == 0);
+	}
+
+	// a is at least twice as long as b, multiply b with slices of a of b's length
+	static void mul_unbalanced(limb_t* destination, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length)
+	{
+		std::size_t destination_length = a_length + b_length;
+		std::fill(destination, destination + destination_length, 0);
+
+		// in parallel one batch has a slice for every thread, the partial products are added afterwards
+		std::size_t slice_count = (a_length + b_length - 1) / b_length;
+		std::size_t batch_size = use_parallel(b_length) ? std::min(slice_count, BigInt::thread_count) : 1;
+		limb_vector partials(batch_size * 2 * b_length);
+		for (std::size_t batch_offset = 0; batch_offset < a_length; batch_offset += batch_size * b_length) {
+			std::size_t batch_end = std::min(a_length, batch_offset + batch_size * b_length);
+			if (batch_size == 1) {
+				mul(partials.data(), a + batch_offset, batch_end - batch_offset, b, b_length);
+			}
+			else {
+				TaskGroup group;
+				for (std::size_t offset = batch_offset; offset < batch_end; offset += b_length) {
+					limb_t* partial = partials.data() + 2 * (offset - batch_offset);
+					std::size_t slice_length = std::min(b_length, a_length - offset);
+					group.run([=] { mul(partial, a + offset, slice_length, b, b_length); });
+				}
+				group.wait();
+			}
+
+			for (std::size_t offset = batch_offset; offset < batch_end; offset += b_length) {
+				const limb_t* partial = partials.data() + 2 * (offset - batch_offset);
+				std::size_t slice_length = std::min(b_length, a_length - offset);
+				add(destination + offset, destination + offset, destination_length - offset, partial, slice_length + b_length);
+			}
+		}
+	}
+
+	// a = a1 * B^m + a0, b = b1 * B^m + b0
+	// a * b = a1b1 * B^2m + ((a0 + a1)(b0 + b1) - a0b0 - a1b1) * B^m + a0b0
+	static void mul_karatsuba(limb_t* destination, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length)
+	{
+		std::size_t m = (a_length + 1) / 2;
+		assert(b_length > m);
+
+		const limb_t* a0 = a;
+		const limb_t* a1 = a + m;
+		const limb_t* b0 = b;
+		const limb_t* b1 = b + m;
+		std::size_t a1_length = a_length - m;
+		std::size_t b1_length = b_length - m;
+
+		limb_vector a_sum(m + 1);
+		limb_vector b_sum(m + 1);
+		a_sum[m] = add(a_sum.data(), a0, m, a1, a1_length);
+		b_sum[m] = add(b_sum.data(), b0, m, b1, b1_length);
+
+		// the low and high products go straight to their final position
+		limb_vector middle(2 * m + 2);
+		if (use_parallel(b_length)) {
+			TaskGroup group;
+			group.run([=] { mul(destination, a0, m, b0, m); });
+			group.run([=] { mul(destination + 2 * m, a1, a1_length, b1, b1_length); });
+			group.run([&] { mul(middle.data(), a_sum.data(), m + 1, b_sum.data(), m + 1); });
+			group.wait();
+		}
+		else {
+			mul(destination, a0, m, b0, m);
+			mul(destination + 2 * m, a1, a1_length, b1, b1_length);
+			mul(middle.data(), a_sum.data(), m + 1, b_sum.data(), m + 1);
+		}
+
+		sub(middle.data(), middle.data(), middle.size(), destination, 2 * m);
+		sub(middle.data(), middle.data(), middle.size(), destination + 2 * m, a1_length + b1_length);
+
+		middle.resize(trimmed_length(middle.data(), middle.size()));
+		add_at(destination, a_length + b_length, m, middle);
+	}
+
+	// a = a1 * B^m + a0
+	// a^2 = a1^2 * B^2m + ((a0 + a1)^2 - a0^2 - a1^2) * B^m + a0^2, three squares instead of three products
+	static void sqr_karatsuba(limb_t* destination, const limb_t* a, std::size_t a_length)
+	{
+		std::size_t m = (a_length + 1) / 2;
+		const limb_t* a0 = a;
+		const limb_t* a1 = a + m;
+		std::size_t a1_length = a_length - m;
+
+		limb_vector a_sum(m + 1);
+		a_sum[m] = add(a_sum.data(), a0, m, a1, a1_length);
+
+		limb_vector middle(2 * m + 2);
+		if (use_parallel(a_length)) {
+			TaskGroup group;
+			group.run([=] { sqr(destination, a0, m); });
+			group.run([=] { sqr(destination + 2 * m, a1, a1_length); });
+			group.run([&] { sqr(middle.data(), a_sum.data(), m + 1); });
+			group.wait();
+		}
+		else {
+			sqr(destination, a0, m);
+			sqr(destination + 2 * m, a1, a1_length);
+			sqr(middle.data(), a_sum.data(), m + 1);
+		}
+
+		sub(middle.data(), middle.data(), middle.size(), destination, 2 * m);
+		sub(middle.data(), middle.data(), middle.size(), destination + 2 * m, 2 * a1_length);
+
+		middle.resize(trimmed_length(middle.data(), middle.size()));
+		add_at(destination, 2 * a_length, m, middle);
+	}
+
+	// splits both numbers into three pieces of k limbs and evaluates them at 0, 1, -1, -2 and infinity
+	// interpolation sequence by Bodrato
+	static void mul_toom3(limb_t* destination, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length)
+	{
+		std::size_t k = (a_length + 2) / 3;
+		assert(b_length > 2 * k);
+
+		// a square evaluates its operand once, the five products of equal values become squares in mul
+		bool is_square = a == b && a_length == b_length;
+
+		SignedLimbs values_a[5];
+		SignedLimbs values_b_storage[5];
+		SignedLimbs* values_b = is_square ? values_a : values_b_storage;
+		const limb_t* operands[2] = { a, b };
+		std::size_t lengths[2] = { a_length, b_length };
+		SignedLimbs* values[2] = { values_a, values_b };
+
+		for (int i = 0; i < (is_square ? 1 : 2); i++) {
+			SignedLimbs p0 = slice(operands[i], lengths[i], 0, k);
+			SignedLimbs p1 = slice(operands[i], lengths[i], k, k);
+			SignedLimbs p2 = slice(operands[i], lengths[i], 2 * k, lengths[i] - 2 * k);
+
+			SignedLimbs outer_sum = signed_add(p0, p2);
+			values[i][1] = signed_add(outer_sum, p1);
+			values[i][2] = signed_sub(outer_sum, p1);
+			// p(-2) = (p(-1) + p2) * 2 - p0
+			values[i][3] = signed_add(values[i][2], p2);
+			signed_mul_small(values[i][3], 2);
+			values[i][3] = signed_sub(values[i][3], p0);
+			values[i][0] = p0;
+			values[i][4] = p2;
+		}
+
+		SignedLimbs r[5];
+		for (int i = 0; i < 5; i++)
+			r[i].magnitude.resize(values_a[i].magnitude.size() + values_b[i].magnitude.size());
+
+		if (use_parallel(b_length)) {
+			TaskGroup group;
+			for (int i = 0; i < 5; i++)
+				group.run([&, i] { signed_mul(r[i], values_a[i], values_b[i]); });
+			group.wait();
+		}
+		else {
+			for (int i = 0; i < 5; i++)
+				signed_mul(r[i], values_a[i], values_b[i]);
+		}
+
+		// r[0] = r(0), r[1] = r(1), r[2] = r(-1), r[3] = r(-2), r[4] = r(inf)
+		SignedLimbs c3 = signed_sub(r[3], r[1]);
+		signed_div_exact_small(c3, 3);
+		SignedLimbs c1 = signed_sub(r[1], r[2]);
+		signed_div_exact_small(c1, 2);
+		SignedLimbs c2 = signed_sub(r[2], r[0]);
+		c3 = signed_sub(c2, c3);
+		signed_div_exact_small(c3, 2);
+		SignedLimbs twice_infinity = r[4];
+		signed_mul_small(twice_infinity, 2);
+		c3 = signed_add(c3, twice_infinity);
+		c2 = signed_add(c2, c1);
+		c2 = signed_sub(c2, r[4]);
+		c1 = signed_sub(c1, c3);
+
+		// all coefficients of the product polynomial are positive again
+		assert(!c1.is_negative && !c2.is_negative && !c3.is_negative);
+
+		std::size_t destination_length = a_length + b_length;
+		std::fill(destination, destination + destination_length, 0);
+		add_at(destination, destination_length, 0, r[0].magnitude);
+		add_at(destination, destination_length, k, c1.magnitude);
+		add_at(destination, destination_length, 2 * k, c2.magnitude);
+		add_at(destination, destination_length, 3 * k, c3.magnitude);
+		add_at(destination, destination_length, 4 * k, r[4].magnitude);
+	}
+
+	void mul(limb_t* destination, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length)
+	{
+		// let a be the longer operand
+		if (a_length < b_length) {
+			std::swap(a, b);
+			std::swap(a_length, b_length);
+		}
+
+		// x * x, e.g. from x *= x or inside pow, needs only about half of the limb products
+		if (a == b && a_length == b_length) {
+			sqr(destination, a, a_length);
+			return;
+		}
+
+		// below four limbs the karatsuba sums are as long as the operands and the recursion would not end
+		if (b_length < BigInt::karatsuba_threshold || b_length < 4) {
+			mul_schoolbook(destination, a, a_length, b, b_length);
+			return;
+		}
+
+		// products too long for one transform are split by the other algorithms until the pieces fit
+		bool use_ntt = b_length >= BigInt::ntt_threshold && a_length + b_length <= ntt_max_product_length();
+		if (use_ntt) {
+			mul_ntt(destination, a, a_length, b, b_length);
+			return;
+		}
+
+		// karatsuba and toom-3 only pay off for operands of similar length
+		std::size_t half = (a_length + 1) / 2;
+		if (b_length <= half) {
+			mul_unbalanced(destination, a, a_length, b, b_length);
+			return;
+		}
+
+		std::size_t third = (a_length + 2) / 3;
+		bool use_toom3 = b_length >= BigInt::toom3_threshold && b_length > 2 * third;
+		if (use_toom3)
+			mul_toom3(destination, a, a_length, b, b_length);
+		else
+			mul_karatsuba(destination, a, a_length, b, b_length);
+	}
+
+	void sqr(limb_t* destination, const limb_t* a, std::size_t a_length)
+	{
+		if (a_length < BigInt::karatsuba_square_threshold || a_length < 4) {
+			sqr_schoolbook(destination, a, a_length);
+			return;
+		}
+
+		// the transform and toom-3 notice that both operands are the same and only transform or evaluate once
+		if (a_length >= BigInt::ntt_threshold && 2 * a_length <= ntt_max_product_length())
+			mul_ntt(destination, a, a_length, a, a_length);
+		else if (a_length >= BigInt::toom3_threshold)
+			mul_toom3(destination, a, a_length, a, a_length);
+		else
+			sqr_karatsuba(destination, a, a_length);
+	}
+
+	std::size_t mul_scratch_length(std::size_t length)
+	{
+		// every karatsuba level needs two sums of m + 1 limbs and their product, the recursion goes on with m + 1 limbs
+		std::size_t scratch_length = 0;
+		while (length >= 4) {
+			std::size_t m = (length + 1) / 2;
+			scratch_length += 4 * m + 4;
+			length = m + 1;
+		}
+		return scratch_length;
+	}
+
+	void mul_scratch(limb_t* destination, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length, limb_t* scratch)
+	{
+		if (a_length < b_length) {
+			std::swap(a, b);
+			std::swap(a_length, b_length);
+		}
+
+		bool is_square = a == b && a_length == b_length;
+		std::size_t threshold = is_square ? BigInt::karatsuba_square_threshold : BigInt::karatsuba_threshold;
+		std::size_t m = (a_length + 1) / 2;
+		// unbalanced operands go to schoolbook as well, the callers multiply numbers of about the same length
+		if (b_length < threshold || b_length < 4 || b_length <= m) {
+			if (is_square)
+				sqr_schoolbook(destination, a, a_length);
+			else
+				mul_schoolbook(destination, a, a_length, b, b_length);
+			return;
+		}
+
+		// same steps as mul_karatsuba, a square only adds up its halves once and squares all three parts
+		limb_t* a_sum = scratch;
+		limb_t* b_sum = is_square ? a_sum : scratch + m + 1;
+		limb_t* middle = scratch + 2 * m + 2;
+		limb_t* rest = middle + 2 * m + 2;
+		a_sum[m] = add(a_sum, a, m, a + m, a_length - m);
+		if (!is_square)
+			b_sum[m] = add(b_sum, b, m, b + m, b_length - m);
+
+		mul_scratch(destination, a, m, b, m, rest);
+		mul_scratch(destination + 2 * m, a + m, a_length - m, b + m, b_length - m, rest);
+		mul_scratch(middle, a_sum, m + 1, b_sum, m + 1, rest);
+
+		sub(middle, middle, 2 * m + 2, destination, 2 * m);
+		sub(middle, middle, 2 * m + 2, destination + 2 * m, a_length + b_length - 2 * m);
+		std::size_t middle_length = trimmed_length(middle, 2 * m + 2);
+		add(destination + m, destination + m, a_length + b_length - m, middle, middle_length);
+	}
+}
@@ -0,0 +1,277 @@
+#include "BigIntLimbs.h"
+
+#include <algorithm>
+#include <cassert>
+
+// -----------------------
+// -- Tunable thresholds
+// -----------------------
+
+std::size_t BigInt::ntt_threshold = 3072;
+
+namespace bigint_limbs
+{
+	// -----------------------
+	// -- Internal Constants for the number theoretic transform
+	// -----------------------
+
+	// three primes of the form c * 2^k + 1 below 2^31, so every product of two residues fits into 64 bits
+	// their product is above 2^90, which is bigger than any convolution coefficient
+	// of at most 2^26 limbs: 2^26 * (2^32 - 1)^2 < 2^90
+	struct NttPrime
+	{
+		std::uint32_t modulus;
+		std::uint32_t primitive_root;
+	};
+
+	const int NTT_PRIME_COUNT = 3;
+	const NttPrime NTT_PRIMES[NTT_PRIME_COUNT] = {
+		{ 2013265921, 31 }, // 15 * 2^27 + 1
+		{ 469762049, 3 },   //  7 * 2^26 + 1
+		{ 1811939329, 13 }, // 27 * 2^26 + 1
+	};
+
+	// every prime has a root of unity of this order
+	const std::size_t NTT_MAX_TRANSFORM_LENGTH = std::size_t(1) << 26;
+
+	// -----------------------
+	// -- Internal Util functions
+	// -----------------------
+
+	static std::uint32_t mul_mod(std::uint32_t a, std::uint32_t b, std::uint32_t modulus)
+	{
+		return static_cast<std::uint32_t>(static_cast<std::uint64_t>(a) * b % modulus);
+	}
+
+	static std::uint32_t pow_mod(std::uint32_t base, std::uint64_t exponent, std::uint32_t modulus)
+	{
+		std::uint32_t result = 1;
+		while (exponent > 0) {
+			if (exponent & 1)
+				result = mul_mod(result, base, modulus);
+			base = mul_mod(base, base, modulus);
+			exponent >>= 1;
+		}
+
+		return result;
+	}
+
+	static std::uint32_t inverse_mod(std::uint32_t a, std::uint32_t modulus)
+	{
+		// fermat, the modulus is prime
+		return pow_mod(a, modulus - 2, modulus);
+	}
+
+	// montgomery arithmetic modulo one prime with R = 2^32, multiplies without a hardware division
+	// needs a modulus below 2^31, so the reduction cannot overflow 64 bits
+	struct Montgomery
+	{
+		std::uint32_t modulus;
+		// -modulus^-1 mod R
+		std::uint32_t modulus_inverse;
+		// R^2 mod modulus, multiplying with it converts into montgomery form
+		std::uint32_t r_squared;
+
+		explicit Montgomery(std::uint32_t modulus) : modulus(modulus)
+		{
+			// newton iteration for the inverse modulo 2^32, every step doubles the number of correct bits
+			std::uint32_t inverse = modulus;
+			for (int i = 0; i < 4; i++)
+				inverse *= 2 - modulus * inverse;
+			modulus_inverse = 0 - inverse;
+
+			std::uint32_t r = static_cast<std::uint32_t>((std::uint64_t(1) << 32) % modulus);
+			r_squared = mul_mod(r, r, modulus);
+		}
+
+		// a * b / R mod modulus, a * b has to be below modulus * R
+		std::uint32_t multiply(std::uint32_t a, std::uint32_t b) const
+		{
+			std::uint64_t product = static_cast<std::uint64_t>(a) * b;
+			std::uint32_t m = static_cast<std::uint32_t>(product) * modulus_inverse;
+			std::uint32_t result = static_cast<std::uint32_t>((product + static_cast<std::uint64_t>(m) * modulus) >> 32);
+			return result >= modulus ? result - modulus : result;
+		}
+
+		// any 32 bit value to montgomery form a * R mod modulus
+		std::uint32_t to_montgomery(std::uint32_t a) const
+		{
+			return multiply(a, r_squared);
+		}
+	};
+
+	// in place iterative radix 2 transform, length has to be a power of two
+	// the values are in montgomery form, the backwards transform also divides by the length and returns the normal form
+	static void ntt(scratch_vector<std::uint32_t>& values, const NttPrime& prime, const Montgomery& montgomery, bool inverse)
+	{
+		std::size_t length = values.size();
+		std::uint32_t modulus = prime.modulus;
+
+		// bit reversal permutation
+		for (std::size_t i = 1, j = 0; i < length; i++) {
+			std::size_t bit = length >> 1;
+			for (; j & bit; bit >>= 1)
+				j ^= bit;
+			j ^= bit;
+
+			if (i < j)
+				std::swap(values[i], values[j]);
+		}
+
+		// the powers of the root are in montgomery form too, so multiplying with them keeps the form of the values
+		scratch_vector<std::uint32_t> roots;
+		for (std::size_t half = 1; half < length; half <<= 1) {
+			// root of unity of order 2 * half, inverted for the backwards transform
+			std::uint32_t root = pow_mod(prime.primitive_root, (modulus - 1) / (2 * half), modulus);
+			if (inverse)
+				root = inverse_mod(root, modulus);
+			std::uint32_t root_montgomery = montgomery.to_montgomery(root);
+
+			roots.resize(half);
+			roots[0] = montgomery.to_montgomery(1);
+			for (std::size_t k = 1; k < half; k++)
+				roots[k] = montgomery.multiply(roots[k - 1], root_montgomery);
+
+			for (std::size_t start = 0; start < length; start += 2 * half) {
+				for (std::size_t k = 0; k < half; k++) {
+					std::uint32_t even = values[start + k];
+					std::uint32_t odd = montgomery.multiply(values[start + k + half], roots[k]);
+					std::uint32_t sum = even + odd;
+					values[start + k] = sum >= modulus ? sum - modulus : sum;
+					values[start + k + half] = even >= odd ? even - odd : even + modulus - odd;
+				}
+			}
+		}
+
+		if (inverse) {
+			// a montgomery multiplication with the plain inverse leaves the normal form
+			std::uint32_t length_inverse = inverse_mod(static_cast<std::uint32_t>(length % modulus), modulus);
+			for (std::size_t i = 0; i < length; i++)
+				values[i] = montgomery.multiply(values[i], length_inverse);
+		}
+	}
+
+	// cyclic convolution of a and b modulo one prime, the result is left in transformed_a
+	// transformed_a has to hold transform_length values already, so it can be filled by another thread
+	static void convolve(scratch_vector<std::uint32_t>& transformed_a, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length, std::size_t transform_length, const NttPrime& prime, bool is_parallel)
+	{
+		Montgomery montgomery(prime.modulus);
+
+		std::fill(transformed_a.begin(), transformed_a.end(), 0);
+		for (std::size_t i = 0; i < a_length; i++)
+			transformed_a[i] = montgomery.to_montgomery(a[i]);
+
+		// a square needs only one forward transform
+		if (a == b && a_length == b_length) {
+			ntt(transformed_a, prime, montgomery, false);
+			for (std::size_t i = 0; i < transform_length; i++)
+				transformed_a[i] = montgomery.multiply(transformed_a[i], transformed_a[i]);
+			ntt(transformed_a, prime, montgomery, true);
+			return;
+		}
+
+		scratch_vector<std::uint32_t> transformed_b(transform_length, 0);
+		for (std::size_t i = 0; i < b_length; i++)
+			transformed_b[i] = montgomery.to_montgomery(b[i]);
+
+		// the forward transforms of both operands are independent
+		if (is_parallel) {
+			TaskGroup group;
+			group.run([&] { ntt(transformed_a, prime, montgomery, false); });
+			ntt(transformed_b, prime, montgomery, false);
+			group.wait();
+		}
+		else {
+			ntt(transformed_a, prime, montgomery, false);
+			ntt(transformed_b, prime, montgomery, false);
+		}
+		for (std::size_t i = 0; i < transform_length; i++)
+			transformed_a[i] = montgomery.multiply(transformed_a[i], transformed_b[i]);
+		ntt(transformed_a, prime, montgomery, true);
+	}
+
+	// 128 bit unsigned value as two halves, enough for one reconstructed coefficient plus the running carry
+	struct WideValue
+	{
+		std::uint64_t low;
+		std::uint64_t high;
+	};
+
+	static void add_wide(WideValue& value, std::uint64_t addend)
+	{
+		value.low += addend;
+		if (value.low < addend)
+			value.high++;
+	}
+
+	// -----------------------
+	// -- Multiplication
+	// -----------------------
+
+	std::size_t ntt_max_product_length()
+	{
+		return NTT_MAX_TRANSFORM_LENGTH;
+	}
+
+	void mul_ntt(limb_t* destination, const limb_t* a, std::size_t a_length, const limb_t* b, std::size_t b_length)
+	{
+		std::size_t destination_length = a_length + b_length;
+		assert(destination_length <= NTT_MAX_TRANSFORM_LENGTH);
+
+		std::size_t transform_length = 1;
+		while (transform_length < destination_length)
+			transform_length <<= 1;
+
+		// every prime is a convolution of its own, in parallel they run side by side
+		bool is_parallel = use_parallel(std::min(a_length, b_length));
+		scratch_vector<std::uint32_t> residues[NTT_PRIME_COUNT];
+		for (int i = 0; i < NTT_PRIME_COUNT; i++)
+			residues[i].resize(transform_length);
+
+		if (is_parallel) {
+			TaskGroup group;
+			for (int i = 0; i < NTT_PRIME_COUNT; i++)
+				group.run([&, i] { convolve(residues[i], a, a_length, b, b_length, transform_length, NTT_PRIMES[i], true); });
+			group.wait();
+		}
+		else {
+			for (int i = 0; i < NTT_PRIME_COUNT; i++)
+				convolve(residues[i], a, a_length, b, b_length, transform_length, NTT_PRIMES[i], false);
+		}
+
+		// constants for garner's algorithm
+		const std::uint32_t p1 = NTT_PRIMES[0].modulus;
+		const std::uint32_t p2 = NTT_PRIMES[1].modulus;
+		const std::uint32_t p3 = NTT_PRIMES[2].modulus;
+		const std::uint32_t p1_inverse_mod_p2 = inverse_mod(p1 % p2, p2);
+		const std::uint32_t p1p2_inverse_mod_p3 = inverse_mod(mul_mod(p1 % p3, p2 % p3, p3), p3);
+		const std::uint64_t p1p2 = static_cast<std::uint64_t>(p1) * p2;
+		const std::uint32_t p1p2_low = static_cast<std::uint32_t>(p1p2);
+		const std::uint32_t p1p2_high = static_cast<std::uint32_t>(p1p2 >> 32);
+
+		// carry stays below 2^60 since every coefficient is below 2^91
+		std::uint64_t carry = 0;
+		for (std::size_t i = 0; i < destination_length; i++) {
+			// x = v1 + v2 * p1 + v3 * p1 * p2 with v_i < p_i
+			std::uint32_t v1 = residues[0][i];
+			std::uint32_t v2 = mul_mod((residues[1][i] + p2 - v1 % p2) % p2, p1_inverse_mod_p2, p2);
+			std::uint64_t low_part = v1 + static_cast<std::uint64_t>(v2) * p1;
+			std::uint32_t v3 = mul_mod((residues[2][i] + p3 - static_cast<std::uint32_t>(low_part % p3)) % p3, p1p2_inverse_mod_p3, p3);
+
+			// v3 * p1p2 split into two partial products below 2^64
+			std::uint64_t product_low = static_cast<std::uint64_t>(v3) * p1p2_low;
+			std::uint64_t product_high = static_cast<std::uint64_t>(v3) * p1p2_high;
+
+			WideValue value = { carry, 0 };
+			add_wide(value, low_part);
+			add_wide(value, product_low);
+			add_wide(value, product_high << 32);
+			value.high += product_high >> 32;
+
+			destination[i] = static_cast<limb_t>(value.low);
+			carry = (value.low >> 32) | (value.high << 32);
+		}
+
+		assert(carry == 0);
+	}
+}
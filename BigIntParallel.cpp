@@ -0,0 +1,246 @@
+#include "BigIntLimbs.h"
+
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <utility>
+
+// -----------------------
+// -- Tunable thresholds
+// -----------------------
+
+std::size_t BigInt::thread_count = 1;
+std::size_t BigInt::parallel_threshold = 1024;
+
+namespace bigint_limbs
+{
+	// -----------------------
+	// -- Internal thread pool
+	// -----------------------
+
+	struct Task
+	{
+		std::function<void()> function;
+		TaskGroup* group;
+	};
+
+	// every worker has its own queue, it takes the newest task from it and steals the oldest from the others
+	// threads outside the pool share one more queue
+	class ThreadPool : public std::enable_shared_from_this<ThreadPool>
+	{
+		public:
+			explicit ThreadPool(std::size_t worker_count);
+			~ThreadPool();
+
+			ThreadPool(const ThreadPool&) = delete;
+			ThreadPool& operator=(const ThreadPool&) = delete;
+
+			std::size_t worker_count() const { return workers.size(); }
+
+			void push(Task task);
+
+			// runs one queued task on the calling thread, returns false if there was none
+			bool run_one();
+
+		private:
+			struct Queue
+			{
+				std::mutex mutex;
+				std::deque<Task> tasks;
+			};
+
+			std::vector<std::thread> workers;
+			std::deque<Queue> queues;
+			// number of tasks in all queues, idle workers sleep while it is zero
+			std::atomic<std::size_t> queued;
+			std::mutex sleep_mutex;
+			std::condition_variable wake;
+			bool is_stopping;
+
+			std::size_t own_queue() const;
+			bool pop(std::size_t index, Task& task);
+			void work(std::size_t index);
+	};
+
+	// the pool and queue of a worker thread, nullptr on all other threads
+	static thread_local ThreadPool* worker_pool = nullptr;
+	static thread_local std::size_t worker_index = 0;
+
+	ThreadPool::ThreadPool(std::size_t worker_count) : queues(worker_count + 1), queued(0), is_stopping(false)
+	{
+		for (std::size_t i = 0; i < worker_count; i++)
+			workers.emplace_back(&ThreadPool::work, this, i);
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+			is_stopping = true;
+		}
+		wake.notify_all();
+
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+	std::size_t ThreadPool::own_queue() const
+	{
+		return worker_pool == this ? worker_index : workers.size();
+	}
+
+	void ThreadPool::push(Task task)
+	{
+		Queue& queue = queues[own_queue()];
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.tasks.push_back(std::move(task));
+		}
+		queued++;
+
+		// taking the lock makes sure a worker between its check and its sleep gets the notification
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+		}
+		wake.notify_one();
+	}
+
+	bool ThreadPool::pop(std::size_t index, Task& task)
+	{
+		{
+			// the newest own task, its data is most likely still in the cache
+			Queue& queue = queues[index];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.tasks.empty()) {
+				task = std::move(queue.tasks.back());
+				queue.tasks.pop_back();
+				queued--;
+				return true;
+			}
+		}
+
+		// steal the oldest task of another queue, it is usually the biggest one
+		for (std::size_t i = 1; i < queues.size(); i++) {
+			Queue& queue = queues[(index + i) % queues.size()];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.tasks.empty()) {
+				task = std::move(queue.tasks.front());
+				queue.tasks.pop_front();
+				queued--;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool ThreadPool::run_one()
+	{
+		Task task;
+		if (!pop(own_queue(), task))
+			return false;
+
+		std::exception_ptr error;
+		try {
+			task.function();
+		}
+		catch (...) {
+			error = std::current_exception();
+		}
+
+		// the captures go before the group learns about the end, the waiting thread may free what they point to
+		task.function = nullptr;
+		task.group->finish(error);
+		return true;
+	}
+
+	void ThreadPool::work(std::size_t index)
+	{
+		worker_pool = this;
+		worker_index = index;
+
+		while (true) {
+			if (run_one())
+				continue;
+
+			std::unique_lock<std::mutex> lock(sleep_mutex);
+			wake.wait(lock, [this] { return is_stopping || queued > 0; });
+			if (is_stopping && queued == 0)
+				return;
+		}
+	}
+
+	// the pool for BigInt::thread_count, replaced when the count changes
+	// groups keep the pool they started with alive, so a replaced pool ends after its last group
+	static std::shared_ptr<ThreadPool> current_pool()
+	{
+		if (worker_pool != nullptr)
+			return worker_pool->shared_from_this();
+
+		static std::mutex mutex;
+		static std::shared_ptr<ThreadPool> pool;
+		std::lock_guard<std::mutex> lock(mutex);
+
+		std::size_t worker_count = BigInt::thread_count > 1 ? BigInt::thread_count - 1 : 0;
+		if (!pool || pool->worker_count() != worker_count)
+			pool = std::make_shared<ThreadPool>(worker_count);
+
+		return pool;
+	}
+
+	// -----------------------
+	// -- Parallel tasks
+	// -----------------------
+
+	bool use_parallel(std::size_t length)
+	{
+		return BigInt::thread_count > 1 && length >= BigInt::parallel_threshold;
+	}
+
+	TaskGroup::TaskGroup() : pool(current_pool()), pending(0)
+	{
+	}
+
+	TaskGroup::~TaskGroup()
+	{
+		wait_for_tasks();
+	}
+
+	void TaskGroup::run(std::function<void()> task)
+	{
+		pending++;
+		pool->push(Task{ std::move(task), this });
+	}
+
+	void TaskGroup::wait()
+	{
+		wait_for_tasks();
+
+		std::exception_ptr task_error;
+		{
+			std::lock_guard<std::mutex> lock(error_mutex);
+			std::swap(task_error, error);
+		}
+		if (task_error)
+			std::rethrow_exception(task_error);
+	}
+
+	void TaskGroup::finish(std::exception_ptr task_error)
+	{
+		if (task_error) {
+			std::lock_guard<std::mutex> lock(error_mutex);
+			if (!error)
+				error = task_error;
+		}
+		pending--;
+	}
+
+	void TaskGroup::wait_for_tasks()
+	{
+		// help with any queued task instead of blocking, this also runs the tasks of the group when all workers are busy
+		while (pending > 0) {
+			if (!pool->run_one())
+				std::this_thread::yield();
+		}
+	}
+}
@@ -0,0 +1,356 @@
+#include "BigIntLimbs.h"
+
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace bigint_limbs
+{
+	// -----------------------
+	// -- Internal Constants for powers
+	// -----------------------
+
+	// 10^e is cached in full for e below DECIMAL_CHUNK_DIGITS * 2^CACHED_DECIMAL_LEVELS, e.g. the scales of fixed point numbers
+	// bigger powers are that cached power times the decimal power levels from CACHED_DECIMAL_LEVELS on
+	const std::size_t CACHED_DECIMAL_LEVELS = 7;
+	const std::size_t CACHED_POWERS_OF_TEN = std::size_t(DECIMAL_CHUNK_DIGITS) << CACHED_DECIMAL_LEVELS;
+
+	// up to this many result limbs a one limb base is multiplied in limb sized steps instead of squared
+	const std::size_t SMALL_POWER_LIMBS = 32;
+
+	// -----------------------
+	// -- Decimal power table
+	// -----------------------
+
+	// all levels computed so far, shared by all threads
+	// the powers are kept until the program ends, so they do not come from the scratch allocator
+	struct PowerTable
+	{
+		std::mutex mutex;
+		std::deque<DecimalPower> powers;
+	};
+
+	static PowerTable& power_table()
+	{
+		static PowerTable table;
+		return table;
+	}
+
+	// every level is the square of the one below, a deque keeps the references stable while it grows
+	// an entry is never changed after it was handed out with the reciprocal
+	const DecimalPower& decimal_power(std::size_t level, bool with_reciprocal)
+	{
+		PowerTable& table = power_table();
+		std::lock_guard<std::mutex> lock(table.mutex);
+
+		if (table.powers.empty()) {
+			table.powers.emplace_back();
+			table.powers.back().power.assign(1, DECIMAL_CHUNK_BASE);
+		}
+
+		while (table.powers.size() <= level) {
+			const std::vector<limb_t>& previous = table.powers.back().power;
+			std::vector<limb_t> square(2 * previous.size());
+			sqr(square.data(), previous.data(), previous.size());
+			square.resize(trimmed_length(square.data(), square.size()));
+			table.powers.emplace_back();
+			table.powers.back().power = std::move(square);
+		}
+
+		DecimalPower& entry = table.powers[level];
+		if (with_reciprocal && entry.reciprocal.empty()) {
+			std::size_t length = entry.power.size();
+			entry.shift = normalization_shift(entry.power.data(), length);
+			entry.normalized.resize(length);
+			shift_left(entry.normalized.data(), entry.power.data(), length, entry.shift);
+
+			limb_vector x = reciprocal(entry.normalized.data(), length);
+			entry.reciprocal.assign(x.begin(), x.end());
+		}
+
+		return entry;
+	}
+
+	// -----------------------
+	// -- Internal power of ten cache
+	// -----------------------
+
+	// the entries are filled on first use and never change afterwards, an empty entry is not computed yet
+	struct PowerOfTenCache
+	{
+		std::mutex mutex;
+		std::vector<std::vector<limb_t>> powers;
+	};
+
+	static PowerOfTenCache& power_of_ten_cache()
+	{
+		static PowerOfTenCache cache;
+		return cache;
+	}
+
+	// 10^exponent for exponent < CACHED_POWERS_OF_TEN, the limbs stay valid until the program ends
+	static const std::vector<limb_t>& cached_power_of_ten(std::size_t exponent)
+	{
+		assert(exponent < CACHED_POWERS_OF_TEN);
+
+		PowerOfTenCache& cache = power_of_ten_cache();
+		std::lock_guard<std::mutex> lock(cache.mutex);
+
+		if (cache.powers.empty())
+			cache.powers.resize(CACHED_POWERS_OF_TEN);
+
+		std::vector<limb_t>& power = cache.powers[exponent];
+		if (power.empty()) {
+			// one chunk of nine digits per step, the rest of the digits in the first step
+			limb_t first = 1;
+			for (std::size_t i = 0; i < exponent % DECIMAL_CHUNK_DIGITS; i++)
+				first *= 10;
+			power.assign(1, first);
+			for (std::size_t i = 0; i < exponent / DECIMAL_CHUNK_DIGITS; i++) {
+				limb_t carry = mul_add_small(power.data(), power.size(), DECIMAL_CHUNK_BASE, 0);
+				if (carry > 0)
+					power.push_back(carry);
+			}
+		}
+
+		return power;
+	}
+
+	// -----------------------
+	// -- Internal Util functions
+	// -----------------------
+
+	// window size of the sliding window for an exponent of bit_count bits
+	// the table of 2^(window - 1) odd powers is small next to the result, but every entry costs one multiplication
+	static unsigned window_bits(std::size_t bit_count)
+	{
+		const std::size_t limits[] = { 8, 24 };
+		unsigned window = 1;
+		for (std::size_t limit : limits) {
+			if (bit_count <= limit)
+				break;
+			window++;
+		}
+
+		return window;
+	}
+
+	// a = a * b for trimmed a and b, a is resized to the trimmed product
+	static void multiply_into(limb_vector& a, const limb_vector& b, limb_vector& scratch)
+	{
+		scratch.resize(a.size() + b.size());
+		if (&a == &b)
+			sqr(scratch.data(), a.data(), a.size());
+		else
+			mul(scratch.data(), a.data(), a.size(), b.data(), b.size());
+		scratch.resize(trimmed_length(scratch.data(), scratch.size()));
+		a.swap(scratch);
+	}
+
+	// a^exponent for a trimmed a of more than one limb or a bigger result, left to right with a sliding window
+	// every window starts and ends with a one bit, the zeros between windows are single squarings
+	static limb_vector power_sliding_window(const limb_t* a, std::size_t a_length, std::uint64_t exponent)
+	{
+		std::size_t bit_count = 64;
+		while (((exponent >> (bit_count - 1)) & 1) == 0)
+			bit_count--;
+		unsigned window = window_bits(bit_count);
+
+		// a^1, a^3, ..., a^(2^window - 1)
+		limb_vector scratch;
+		scratch_vector<limb_vector> table(std::size_t(1) << (window - 1));
+		table[0].assign(a, a + a_length);
+		if (table.size() > 1) {
+			limb_vector square = table[0];
+			multiply_into(square, square, scratch);
+			for (std::size_t i = 1; i < table.size(); i++) {
+				table[i] = table[i - 1];
+				multiply_into(table[i], square, scratch);
+			}
+		}
+
+		limb_vector result;
+		for (std::size_t i = bit_count; i-- > 0;) {
+			if (((exponent >> i) & 1) == 0) {
+				multiply_into(result, result, scratch);
+				continue;
+			}
+
+			std::size_t low = i + 1 >= window ? i + 1 - window : 0;
+			while (((exponent >> low) & 1) == 0)
+				low++;
+
+			std::size_t value = static_cast<std::size_t>((exponent >> low) & ((std::uint64_t(2) << (i - low)) - 1));
+			if (result.empty()) {
+				result = table[value / 2];
+			}
+			else {
+				for (std::size_t j = low; j <= i; j++)
+					multiply_into(result, result, scratch);
+				multiply_into(result, table[value / 2], scratch);
+			}
+			i = low;
+		}
+
+		return result;
+	}
+
+	// a^exponent for a one limb base and a result of at most SMALL_POWER_LIMBS limbs
+	// multiplies by the biggest power of a that still fits into one limb, so there are only a few passes over a short number
+	static void power_small(limb_t* destination, std::size_t destination_length, limb_t a, std::uint64_t exponent)
+	{
+		limb_t step = a;
+		std::uint64_t step_exponent = 1;
+		while (step <= static_cast<limb_t>(-1) / a && step_exponent < exponent) {
+			step *= a;
+			step_exponent++;
+		}
+
+		limb_t first = 1;
+		for (std::uint64_t i = 0; i < exponent % step_exponent; i++)
+			first *= a;
+
+		std::fill(destination, destination + destination_length, 0);
+		destination[0] = first;
+		std::size_t length = 1;
+		for (std::uint64_t i = 0; i < exponent / step_exponent; i++) {
+			limb_t carry = mul_add_small(destination, length, step, 0);
+			if (carry > 0) {
+				assert(length < destination_length);
+				destination[length++] = carry;
+			}
+		}
+	}
+
+	// odd^exponent for a trimmed odd number
+	static limb_vector odd_power(const limb_t* odd, std::size_t odd_length, std::uint64_t exponent)
+	{
+		if (odd_length == 1 && odd[0] == 1)
+			return limb_vector(1, 1);
+
+		std::size_t length = power_length(odd, odd_length, exponent);
+		if (odd_length == 1 && length <= SMALL_POWER_LIMBS) {
+			limb_vector result(length);
+			power_small(result.data(), length, odd[0], exponent);
+			result.resize(trimmed_length(result.data(), length));
+			return result;
+		}
+
+		return power_sliding_window(odd, odd_length, exponent);
+	}
+
+	// writes a * 2^shift without leading zeros to destination and returns its length
+	static std::size_t shift_into(limb_t* destination, const limb_vector& a, std::size_t shift)
+	{
+		std::size_t limb_shift = shift / BigInt::LIMB_BITS;
+		unsigned bit_shift = shift % BigInt::LIMB_BITS;
+		std::fill(destination, destination + limb_shift, 0);
+		limb_t carry = shift_left(destination + limb_shift, a.data(), a.size(), bit_shift);
+		if (carry == 0)
+			return limb_shift + a.size();
+		destination[limb_shift + a.size()] = carry;
+		return limb_shift + a.size() + 1;
+	}
+
+	// -----------------------
+	// -- Powers
+	// -----------------------
+
+	std::size_t power_length(const limb_t* a, std::size_t a_length, std::uint64_t exponent)
+	{
+		std::size_t bits = bit_length(a, a_length);
+		if (bits == 0 || exponent == 0)
+			return 1;
+		// a^exponent < 2^(bits * exponent), that is bits limbs for every LIMB_BITS of the exponent and the rest
+		// the bound is checked in limbs, so neither it nor the length can wrap
+		std::uint64_t whole = exponent / BigInt::LIMB_BITS;
+		if (whole > (BigInt::MAX_LIMBS - 1) / bits)
+			return BigInt::MAX_LIMBS + 1;
+		std::uint64_t length = whole * bits + exponent % BigInt::LIMB_BITS * bits / BigInt::LIMB_BITS + 1;
+		return length > BigInt::MAX_LIMBS ? BigInt::MAX_LIMBS + 1 : static_cast<std::size_t>(length);
+	}
+
+	void pow(limb_t* destination, const limb_t* a, std::size_t a_length, std::uint64_t exponent)
+	{
+		a_length = trimmed_length(a, a_length);
+		std::size_t destination_length = power_length(a, a_length, exponent);
+		// the caller could not have allocated more
+		assert(destination_length <= BigInt::MAX_LIMBS);
+		std::fill(destination, destination + destination_length, 0);
+
+		if (exponent == 0) {
+			destination[0] = 1;
+			return;
+		}
+		if (a_length == 0)
+			return;
+
+		// (10^k)^exponent of one limb is a power of ten
+		if (a_length == 1) {
+			limb_t power = 10;
+			for (std::uint64_t k = 1; k <= static_cast<std::uint64_t>(DECIMAL_CHUNK_DIGITS) && power <= a[0]; k++, power *= 10) {
+				if (power == a[0] && exponent <= UINT64_MAX / k) {
+					power_of_ten(destination, k * exponent);
+					return;
+				}
+			}
+		}
+
+		// a = odd * 2^zeros, so a^exponent = odd^exponent shifted by zeros * exponent bits
+		// the shift is the whole work for a power of two
+		std::size_t zeros = trailing_zero_bits(a, a_length);
+		std::size_t zero_limbs = zeros / BigInt::LIMB_BITS;
+		limb_vector odd(a_length - zero_limbs);
+		shift_right(odd.data(), a + zero_limbs, odd.size(), static_cast<unsigned>(zeros % BigInt::LIMB_BITS));
+		odd.resize(trimmed_length(odd.data(), odd.size()));
+
+		shift_into(destination, odd_power(odd.data(), odd.size(), exponent), zeros * exponent);
+	}
+
+	std::size_t power_of_ten_length(std::uint64_t exponent)
+	{
+		// log2(10) < 10 / 3, so 10^exponent needs at most exponent * 10 / (3 * LIMB_BITS) limbs plus one
+		// that is 5 limbs per block of 3 * LIMB_BITS / 2 exponents, counted in blocks nothing can wrap
+		const std::uint64_t block = 3 * BigInt::LIMB_BITS / 2;
+		std::uint64_t blocks = exponent / block;
+		if (blocks > (BigInt::MAX_LIMBS - 7) / 5)
+			return BigInt::MAX_LIMBS + 1;
+		return static_cast<std::size_t>(blocks * 5 + exponent % block * 5 / block + 2);
+	}
+
+	std::size_t power_of_ten(limb_t* destination, std::uint64_t exponent)
+	{
+		std::size_t destination_length = power_of_ten_length(exponent);
+
+		if (exponent < CACHED_POWERS_OF_TEN) {
+			const std::vector<limb_t>& cached = cached_power_of_ten(static_cast<std::size_t>(exponent));
+			std::copy(cached.begin(), cached.end(), destination);
+			return cached.size();
+		}
+
+		// exponent = rest + DECIMAL_CHUNK_DIGITS * 2^level with a cached rest is one product with a short factor
+		std::uint64_t levels = exponent / CACHED_POWERS_OF_TEN;
+		if ((levels & (levels - 1)) == 0) {
+			std::size_t level = CACHED_DECIMAL_LEVELS;
+			while (levels > 1) {
+				levels >>= 1;
+				level++;
+			}
+
+			const std::vector<limb_t>& power = decimal_power(level).power;
+			const std::vector<limb_t>& rest = cached_power_of_ten(static_cast<std::size_t>(exponent % CACHED_POWERS_OF_TEN));
+			limb_vector product(power.size() + rest.size());
+			mul(product.data(), power.data(), power.size(), rest.data(), rest.size());
+			std::size_t length = trimmed_length(product.data(), product.size());
+			assert(length <= destination_length);
+			std::copy(product.begin(), product.begin() + length, destination);
+			return length;
+		}
+
+		// several levels would take several big products, 10^exponent = 5^exponent * 2^exponent squares a smaller number
+		limb_t five = 5;
+		return shift_into(destination, odd_power(&five, 1, exponent), static_cast<std::size_t>(exponent));
+	}
+}
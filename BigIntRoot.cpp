@@ -0,0 +1,460 @@
+#include "BigIntRoot.h"
+#include "BigIntLimbs.h"
+#include "BigIntView.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+namespace bigint_limbs
+{
+	// -----------------------
+	// -- Internal Util functions
+	// -----------------------
+
+	static void trim(limb_vector& a)
+	{
+		a.resize(trimmed_length(a.data(), a.size()));
+	}
+
+	// a * 2^bits, trimmed
+	static limb_vector shift_left(const limb_t* a, std::size_t length, std::size_t bits)
+	{
+		std::size_t limb_shift = bits / BigInt::LIMB_BITS;
+		limb_vector result(length + limb_shift + 1, 0);
+		result[length + limb_shift] = shift_left(result.data() + limb_shift, a, length, static_cast<unsigned>(bits % BigInt::LIMB_BITS));
+		trim(result);
+		return result;
+	}
+
+	// floor(a / 2^bits), trimmed
+	static limb_vector shift_right(const limb_t* a, std::size_t length, std::size_t bits)
+	{
+		std::size_t limb_shift = bits / BigInt::LIMB_BITS;
+		if (limb_shift >= length)
+			return limb_vector();
+
+		limb_vector result(length - limb_shift);
+		shift_right(result.data(), a + limb_shift, result.size(), static_cast<unsigned>(bits % BigInt::LIMB_BITS));
+		trim(result);
+		return result;
+	}
+
+	// a += b for trimmed numbers
+	static void add_to(limb_vector& a, const limb_t* b, std::size_t b_length)
+	{
+		std::size_t length = std::max(a.size(), b_length);
+		a.resize(length + 1, 0);
+		a[length] = add(a.data(), a.data(), length, b, b_length);
+		trim(a);
+	}
+
+	// a -= b for trimmed numbers, a has to be at least b
+	static void sub_from(limb_vector& a, const limb_t* b, std::size_t b_length)
+	{
+		limb_t borrow = sub(a.data(), a.data(), a.size(), b, b_length);
+		assert(borrow == 0);
+		(void)borrow;
+		trim(a);
+	}
+
+	// a mod m without changing a
+	static limb_t mod_small(const limb_t* a, std::size_t length, limb_t m)
+	{
+		double_limb_t remainder = 0;
+		for (std::size_t i = length; i-- > 0;)
+			remainder = (remainder << BigInt::LIMB_BITS | a[i]) % m;
+		return static_cast<limb_t>(remainder);
+	}
+
+	static std::uint64_t to_word(const limb_t* a, std::size_t length)
+	{
+		return (length > 0 ? a[0] : 0) | (length > 1 ? static_cast<std::uint64_t>(a[1]) << BigInt::LIMB_BITS : 0);
+	}
+
+	static BigInt to_big(std::uint64_t value)
+	{
+		limb_t limbs[2] = { static_cast<limb_t>(value), static_cast<limb_t>(value >> BigInt::LIMB_BITS) };
+		return BigInt(BigIntView(limbs, 2, false));
+	}
+
+	static BigInt to_big(const limb_vector& a)
+	{
+		return BigInt(BigIntView(a.data(), a.size(), false));
+	}
+
+	// -----------------------
+	// -- Internal word roots
+	// -----------------------
+
+	static std::uint64_t sqrt_word(std::uint64_t a)
+	{
+		// the double estimate is at most a few units off
+		std::uint64_t root = std::min<std::uint64_t>(static_cast<std::uint64_t>(std::sqrt(static_cast<double>(a))), 0xFFFFFFFF);
+		while (root * root > a)
+			root--;
+		while (root < 0xFFFFFFFF && (root + 1) * (root + 1) <= a)
+			root++;
+		return root;
+	}
+
+	// true if root^k <= a
+	static bool power_fits(std::uint64_t root, std::uint64_t k, std::uint64_t a)
+	{
+		std::uint64_t power = 1;
+		for (std::uint64_t i = 0; i < k; i++) {
+			if (root != 0 && power > a / root)
+				return false;
+			power *= root;
+		}
+		return true;
+	}
+
+	// floor(a^(1/k)) for k >= 2
+	static std::uint64_t root_word(std::uint64_t a, std::uint64_t k)
+	{
+		std::uint64_t root = static_cast<std::uint64_t>(std::pow(static_cast<double>(a), 1.0 / static_cast<double>(k)));
+		while (root > 0 && !power_fits(root, k, a))
+			root--;
+		while (power_fits(root + 1, k, a))
+			root++;
+		return root;
+	}
+
+	static std::uint64_t pow_mod_word(std::uint64_t base, std::uint64_t exponent, std::uint64_t modulus)
+	{
+		std::uint64_t result = 1;
+		for (base %= modulus; exponent > 0; exponent >>= 1) {
+			if (exponent & 1)
+				result = result * base % modulus;
+			base = base * base % modulus;
+		}
+		return result;
+	}
+
+	static bool is_small_prime(std::uint64_t n)
+	{
+		if (n < 2)
+			return false;
+		for (std::uint64_t divisor = 2; divisor * divisor <= n; divisor++) {
+			if (n % divisor == 0)
+				return false;
+		}
+		return true;
+	}
+
+	// -----------------------
+	// -- Internal Square root
+	// -----------------------
+
+	// s = floor(sqrt(a)) and r = a - s^2 for a of 2 * n limbs whose top limb is at least B / 4
+	// s gets n limbs with the highest bit set, r is trimmed and at most 2 * s
+	// zimmermann's karatsuba square root: the root of the upper half of a gives the upper half of s,
+	// one division by twice that root the lower half, like a newton step that doubles the precision
+	static void square_root_normalized(limb_vector& s, limb_vector& r, const limb_t* a, std::size_t n)
+	{
+		if (n == 1) {
+			std::uint64_t value = to_word(a, 2);
+			std::uint64_t root = sqrt_word(value);
+			std::uint64_t remainder = value - root * root;
+			s.assign(1, static_cast<limb_t>(root));
+			r.assign({ static_cast<limb_t>(remainder), static_cast<limb_t>(remainder >> BigInt::LIMB_BITS) });
+			trim(r);
+			return;
+		}
+
+		std::size_t low = n / 2;
+		std::size_t high = n - low;
+
+		limb_vector root_high;
+		limb_vector remainder_high;
+		square_root_normalized(root_high, remainder_high, a + 2 * low, high);
+
+		// q, u = divmod(remainder_high * B^low + the next low limbs of a, 2 * root_high)
+		limb_vector numerator(low + remainder_high.size());
+		std::copy(a + low, a + 2 * low, numerator.begin());
+		std::copy(remainder_high.begin(), remainder_high.end(), numerator.begin() + low);
+		trim(numerator);
+
+		// the highest bit of root_high is set, so the divisor has exactly high + 1 limbs
+		limb_vector divisor(high + 1);
+		for (std::size_t i = 0; i < high; i++)
+			divisor[i] = root_high[i] << 1 | (i > 0 ? root_high[i - 1] >> (BigInt::LIMB_BITS - 1) : 0);
+		divisor[high] = root_high[high - 1] >> (BigInt::LIMB_BITS - 1);
+
+		limb_vector quotient;
+		limb_vector remainder;
+		if (numerator.size() < divisor.size()) {
+			remainder = std::move(numerator);
+		}
+		else {
+			quotient.resize(numerator.size() - divisor.size() + 1);
+			remainder.resize(divisor.size());
+			divmod(quotient.data(), remainder.data(), numerator.data(), numerator.size(), divisor.data(), divisor.size());
+			trim(quotient);
+			trim(remainder);
+		}
+
+		// s = root_high * B^low + q, q is at most B^low
+		s.assign(n + 1, 0);
+		std::copy(root_high.begin(), root_high.end(), s.begin() + low);
+		add(s.data(), s.data(), n + 1, quotient.data(), quotient.size());
+
+		// r = u * B^low + the lowest low limbs of a - q^2
+		r.assign(low + remainder.size(), 0);
+		std::copy(a, a + low, r.begin());
+		std::copy(remainder.begin(), remainder.end(), r.begin() + low);
+		trim(r);
+
+		limb_vector quotient_square(2 * quotient.size());
+		if (!quotient.empty())
+			sqr(quotient_square.data(), quotient.data(), quotient.size());
+		trim(quotient_square);
+
+		// s is one too big at most, the remainder of s - 1 is r + 2 * s - 1
+		if (cmp(r.data(), r.size(), quotient_square.data(), quotient_square.size()) == CMP_SECOND_PARAMETER_BIGGER) {
+			limb_t one = 1;
+			limb_vector twice_s = shift_left(s.data(), s.size(), 1);
+			add_to(r, twice_s.data(), twice_s.size());
+			sub_from(r, &one, 1);
+			sub(s.data(), s.data(), s.size(), &one, 1);
+		}
+		sub_from(r, quotient_square.data(), quotient_square.size());
+
+		assert(s[n] == 0);
+		s.resize(n);
+	}
+
+	// s = floor(sqrt(a)) and r = a - s^2 for any trimmed a, both trimmed
+	static void square_root(limb_vector& s, limb_vector& r, const limb_t* a, std::size_t length)
+	{
+		if (length <= 2) {
+			std::uint64_t value = to_word(a, length);
+			std::uint64_t root = sqrt_word(value);
+			std::uint64_t remainder = value - root * root;
+			s.assign({ static_cast<limb_t>(root) });
+			r.assign({ static_cast<limb_t>(remainder), static_cast<limb_t>(remainder >> BigInt::LIMB_BITS) });
+			trim(s);
+			trim(r);
+			return;
+		}
+
+		// shift a by an even number of bits, so its top limb is at least B / 4 and its length even
+		// the root is shifted by half of them, which are less than one limb
+		std::size_t leading_zeros = BigInt::LIMB_BITS - bit_length(a + length - 1, 1);
+		unsigned half_shift = static_cast<unsigned>(leading_zeros / 2 + (length % 2 == 1 ? BigInt::LIMB_BITS / 2 : 0));
+		limb_vector normalized = shift_left(a, length, 2 * half_shift);
+
+		limb_vector root;
+		limb_vector remainder;
+		square_root_normalized(root, remainder, normalized.data(), normalized.size() / 2);
+		if (half_shift == 0) {
+			s = std::move(root);
+			r = std::move(remainder);
+			return;
+		}
+
+		// with root = s * 2^c + low, a * 2^(2c) = root^2 + remainder gives a - s^2 = (remainder + low * (2 * root - low)) / 2^(2c)
+		limb_t low = root[0] & ((limb_t(1) << half_shift) - 1);
+		limb_vector correction = shift_left(root.data(), root.size(), 1);
+		sub_from(correction, &low, 1);
+		correction.push_back(0);
+		correction.back() = mul_add_small(correction.data(), correction.size() - 1, low, 0);
+		trim(correction);
+		add_to(correction, remainder.data(), remainder.size());
+
+		r = shift_right(correction.data(), correction.size(), 2 * half_shift);
+		s = shift_right(root.data(), root.size(), half_shift);
+	}
+
+	// -----------------------
+	// -- Internal k-th root
+	// -----------------------
+
+	// one newton step for the k-th root of a from x > 0: ((k - 1) * x + a / x^(k - 1)) / k
+	// it never goes below floor(a^(1/k)), the mean of k - 1 times x and a / x^(k - 1) is at least their geometric mean
+	static BigInt newton_step(const BigInt& a, const BigInt& x, std::uint64_t k)
+	{
+		BigInt divisor = pow(x, k - 1);
+
+		// the quotient has about as many limbs as x, so only that many leading limbs of a and the divisor matter
+		// dropping the same low bits of both never makes the quotient smaller and makes it one bigger at most
+		std::size_t x_length = BigIntView(x).get_length();
+		std::size_t divisor_length = BigIntView(divisor).get_length();
+		BigInt next(0);
+		if (divisor_length > x_length + 2) {
+			std::size_t dropped_bits = (divisor_length - x_length - 2) * BigInt::LIMB_BITS;
+			next = a >> dropped_bits;
+			next /= divisor >> dropped_bits;
+		}
+		else {
+			next = a / divisor;
+		}
+
+		next += x * to_big(k - 1);
+		next /= to_big(k);
+		return next;
+	}
+
+	// at least floor(a^(1/k)) and off by a few units at most, for a >= 1 and k >= 2
+	static BigInt root_estimate(const BigInt& a, std::uint64_t k)
+	{
+		BigIntView view(a);
+		std::size_t bits = bit_length(view.get_limbs(), view.get_length());
+		// a < 2^k, so the root is 1
+		if (bits <= k)
+			return BigInt(1);
+		if (bits <= 64)
+			return to_big(root_word(to_word(view.get_limbs(), view.get_length()), k));
+
+		// the upper half of the root bits comes from the root of the leading bits of a, the newton step adds the lower half
+		std::size_t root_bits = (bits - 1) / k + 1;
+		std::size_t low_bits = root_bits / 2;
+		BigInt x = (root_estimate(a >> (k * low_bits), k) + 1) << low_bits;
+		return newton_step(a, x, k);
+	}
+
+	// floor(a^(1/k)) for a >= 1 and k >= 2, is_exact tells if its k-th power is a
+	static BigInt root_floor(const BigInt& a, std::uint64_t k, bool& is_exact)
+	{
+		// newton steps from above decrease until they reach the root, usually the estimate is already there
+		BigInt x = root_estimate(a, k);
+		BigInt x_power = pow(x, k);
+		while (x_power > a) {
+			// x is above the root, so x - 1 is still at least the floor
+			x = std::min(newton_step(a, x, k), x - 1);
+			x_power = pow(x, k);
+		}
+		is_exact = x_power == a;
+		return x;
+	}
+
+	// -----------------------
+	// -- Internal Perfect powers
+	// -----------------------
+
+	// false if a can not be a p-th power for a prime p
+	// modulo a prime q = j * p + 1 only one in p residues x != 0 is a p-th power, those with x^j = 1
+	static bool may_be_power(const limb_t* a, std::size_t length, std::uint64_t p)
+	{
+		int tested = 0;
+		for (std::uint64_t q = p + 1; tested < 4 && q < 0xFFFFFFFF; q += p) {
+			if (!is_small_prime(q))
+				continue;
+			tested++;
+			limb_t residue = mod_small(a, length, static_cast<limb_t>(q));
+			if (residue != 0 && pow_mod_word(residue, (q - 1) / p, q) != 1)
+				return false;
+		}
+		return true;
+	}
+
+	// the smallest prime p >= first with a = root^p for a >= 2, only odd ones if is_odd_only, 0 if there is none
+	static std::uint64_t smallest_root(const BigInt& a, std::uint64_t first, bool is_odd_only, BigInt& root)
+	{
+		BigIntView view(a);
+		std::size_t bits = bit_length(view.get_limbs(), view.get_length());
+		std::size_t zeros = trailing_zero_bits(view.get_limbs(), view.get_length());
+
+		// a root of at least 2 has p < bits, and p divides the exponent of two in a
+		std::uint64_t last = zeros > 0 ? std::min(zeros, bits - 1) : bits - 1;
+		for (std::uint64_t p = std::max<std::uint64_t>(first, is_odd_only ? 3 : 2); p <= last; p++) {
+			if (zeros % p != 0 || !is_small_prime(p) || !may_be_power(view.get_limbs(), view.get_length(), p))
+				continue;
+
+			if (p == 2) {
+				limb_vector s;
+				limb_vector r;
+				square_root(s, r, view.get_limbs(), view.get_length());
+				if (r.empty()) {
+					root = to_big(s);
+					return p;
+				}
+			}
+			else {
+				bool is_exact = false;
+				BigInt candidate = root_floor(a, p, is_exact);
+				if (is_exact) {
+					root = std::move(candidate);
+					return p;
+				}
+			}
+		}
+		return 0;
+	}
+}
+
+using namespace bigint_limbs;
+
+// -----------------------
+// -- Roots
+// -----------------------
+
+BigInt isqrt(const BigInt& a)
+{
+	return sqrtrem(a).first;
+}
+
+std::pair<BigInt, BigInt> sqrtrem(const BigInt& a)
+{
+	BigIntView view(a);
+	assert(!view.get_is_negative());
+
+	limb_vector root;
+	limb_vector remainder;
+	square_root(root, remainder, view.get_limbs(), view.get_length());
+	return std::make_pair(to_big(root), to_big(remainder));
+}
+
+BigInt iroot(const BigInt& a, std::uint64_t k)
+{
+	BigIntView view(a);
+	assert(k >= 1 && (!view.get_is_negative() || k % 2 == 1));
+
+	if (k == 1 || view.get_length() == 0)
+		return a;
+
+	BigInt magnitude(BigIntView(view.get_limbs(), view.get_length(), false));
+	bool is_exact = false;
+	BigInt root = k == 2 ? isqrt(magnitude) : root_floor(magnitude, k, is_exact);
+	return view.get_is_negative() ? BigInt(0) - root : root;
+}
+
+bool is_perfect_power(const BigInt& a)
+{
+	BigIntView view(a);
+	BigInt magnitude(BigIntView(view.get_limbs(), view.get_length(), false));
+	if (magnitude <= 1)
+		return true;
+
+	BigInt root(0);
+	return smallest_root(magnitude, 2, view.get_is_negative(), root) != 0;
+}
+
+bool is_perfect_power(const BigInt& a, BigInt& base, std::uint64_t& exponent)
+{
+	BigIntView view(a);
+	bool is_negative = view.get_is_negative();
+	BigInt magnitude(BigIntView(view.get_limbs(), view.get_length(), false));
+	if (magnitude <= 1) {
+		exponent = is_negative ? 3 : 2;
+		base = a;
+		return true;
+	}
+
+	// a root of a p-th power has no prime exponent below p, otherwise a would have it too
+	std::uint64_t total_exponent = 1;
+	BigInt root(0);
+	for (std::uint64_t p = 2; (p = smallest_root(magnitude, p, is_negative, root)) != 0;) {
+		magnitude = std::move(root);
+		total_exponent *= p;
+	}
+	if (total_exponent == 1)
+		return false;
+
+	base = is_negative ? BigInt(0) - magnitude : magnitude;
+	exponent = total_exponent;
+	return true;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "BigInt.h"
+
+#include <cstdint>
+#include <utility>
+
+// integer roots with newton steps that double the precision of the root
+// every step only works on as many leading limbs of the operand as the precision it reaches,
+// so only the last one touches the whole number
+
+// floor(sqrt(a)), a must not be negative
+BigInt isqrt(const BigInt& a);
+
+// the square root s = isqrt(a) and the remainder a - s * s, which is between 0 and 2 * s
+// both come out of the same recursion, there is no square and subtraction afterwards
+std::pair<BigInt, BigInt> sqrtrem(const BigInt& a);
+
+// the k-th root of a rounded towards zero, k has to be at least 1
+// a may only be negative for an odd k
+BigInt iroot(const BigInt& a, std::uint64_t k);
+
+// true if a = b^k for some integer b and k >= 2, e.g. 0, 1, 36 and -8
+bool is_perfect_power(const BigInt& a);
+// also returns the b with the smallest absolute value and its k, for 0 and 1 that is a^2 and for -1 (-1)^3
+// base and exponent are only written if a is a perfect power
+bool is_perfect_power(const BigInt& a, BigInt& base, std::uint64_t& exponent);
@@ -0,0 +1,317 @@
+#include "BigIntLimbs.h"
+
+#if defined(BIGINT_X86_SIMD)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// gcc and clang only allow the intrinsics in functions compiled for the instruction set
+// msvc accepts them everywhere, the cpu check happens at runtime in both cases
+#if defined(__GNUC__)
+#define BIGINT_TARGET(isa) __attribute__((target(isa)))
+#else
+#define BIGINT_TARGET(isa)
+#endif
+
+// -----------------------
+// -- Tunable thresholds
+// -----------------------
+
+// the detected cpu features limit it further
+BigInt::SimdLevel BigInt::simd_level = BigInt::SIMD_AVX512;
+
+namespace bigint_limbs
+{
+	// -----------------------
+	// -- Cpu feature detection
+	// -----------------------
+
+	static BigInt::SimdLevel detect_simd_level()
+	{
+#if defined(BIGINT_X86_SIMD) && defined(__GNUC__)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f"))
+			return BigInt::SIMD_AVX512;
+		if (__builtin_cpu_supports("avx2"))
+			return BigInt::SIMD_AVX2;
+#elif defined(BIGINT_X86_SIMD) && defined(_MSC_VER)
+		int registers[4];
+		__cpuid(registers, 0);
+		if (registers[0] < 7)
+			return BigInt::SIMD_PORTABLE;
+
+		// the os has to save the ymm and zmm registers on a context switch
+		__cpuid(registers, 1);
+		bool has_osxsave = (registers[2] & (1 << 27)) != 0;
+		if (!has_osxsave)
+			return BigInt::SIMD_PORTABLE;
+		unsigned long long enabled_state = _xgetbv(0);
+
+		__cpuidex(registers, 7, 0);
+		bool has_avx2 = (registers[1] & (1 << 5)) != 0 && (enabled_state & 0x6) == 0x6;
+		bool has_avx512 = (registers[1] & (1 << 16)) != 0 && (enabled_state & 0xE6) == 0xE6;
+		if (has_avx512)
+			return BigInt::SIMD_AVX512;
+		if (has_avx2)
+			return BigInt::SIMD_AVX2;
+#endif
+		return BigInt::SIMD_PORTABLE;
+	}
+
+	// zero until the dynamic initialization of this file ran, which is SIMD_PORTABLE and always safe
+	static const BigInt::SimdLevel detected_level = detect_simd_level();
+
+	BigInt::SimdLevel active_simd_level()
+	{
+		return BigInt::simd_level < detected_level ? BigInt::simd_level : detected_level;
+	}
+
+#if defined(BIGINT_X86_SIMD)
+	// -----------------------
+	// -- AVX2 kernels, 8 limbs per step
+	// -----------------------
+	// A carry can only ripple through a lane whose sum is all ones (the lane "propagates") and starts in
+	// a lane whose sum overflowed (the lane "generates"). With one bit per lane in two masks g and p,
+	// the carries into all lanes are (((g << 1) | carry_in) + p) ^ p, an ordinary integer addition does
+	// the rippling. The bit above the last lane is the carry out of the whole step. Subtraction works the
+	// same with borrows, where a lane propagates if its difference is zero.
+
+	// one bit per lane to a vector of 0 and 1
+	BIGINT_TARGET("avx2")
+	static __m256i lane_bits_avx2(unsigned mask)
+	{
+		const __m256i lane_shifts = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		return _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(static_cast<int>(mask)), lane_shifts), _mm256_set1_epi32(1));
+	}
+
+	BIGINT_TARGET("avx2")
+	static unsigned lane_mask_avx2(__m256i lanes)
+	{
+		return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(lanes)));
+	}
+
+	// unsigned a < b per lane, avx2 only compares signed
+	BIGINT_TARGET("avx2")
+	static __m256i less_than_avx2(__m256i a, __m256i b)
+	{
+		const __m256i sign = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+		return _mm256_cmpgt_epi32(_mm256_xor_si256(b, sign), _mm256_xor_si256(a, sign));
+	}
+
+	// a + b + carry_in per lane with the carries of the step, carry is updated
+	BIGINT_TARGET("avx2")
+	static __m256i add_lanes_avx2(__m256i a, __m256i b, unsigned& carry)
+	{
+		__m256i sum = _mm256_add_epi32(a, b);
+		unsigned generate = lane_mask_avx2(less_than_avx2(sum, a));
+		unsigned propagate = lane_mask_avx2(_mm256_cmpeq_epi32(sum, _mm256_set1_epi32(-1)));
+
+		unsigned carries = (((generate << 1) | carry) + propagate) ^ propagate;
+		carry = carries >> 8;
+		return _mm256_add_epi32(sum, lane_bits_avx2(carries));
+	}
+
+	BIGINT_TARGET("avx2")
+	limb_t add_n_avx2(limb_t* destination, const limb_t* a, const limb_t* b, std::size_t length, limb_t carry)
+	{
+		unsigned lane_carry = carry;
+		std::size_t i = 0;
+		for (; i + 8 <= length; i += 8) {
+			__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			__m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), add_lanes_avx2(x, y, lane_carry));
+		}
+
+		return add_n_portable(destination + i, a + i, b + i, length - i, lane_carry);
+	}
+
+	BIGINT_TARGET("avx2")
+	limb_t sub_n_avx2(limb_t* destination, const limb_t* a, const limb_t* b, std::size_t length, limb_t borrow)
+	{
+		unsigned lane_borrow = borrow;
+		std::size_t i = 0;
+		for (; i + 8 <= length; i += 8) {
+			__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			__m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+			__m256i difference = _mm256_sub_epi32(x, y);
+			unsigned generate = lane_mask_avx2(less_than_avx2(x, y));
+			unsigned propagate = lane_mask_avx2(_mm256_cmpeq_epi32(difference, _mm256_setzero_si256()));
+
+			unsigned borrows = (((generate << 1) | lane_borrow) + propagate) ^ propagate;
+			lane_borrow = borrows >> 8;
+			difference = _mm256_sub_epi32(difference, lane_bits_avx2(borrows));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), difference);
+		}
+
+		return sub_n_portable(destination + i, a + i, b + i, length - i, lane_borrow);
+	}
+
+	BIGINT_TARGET("avx2")
+	short cmp_n_avx2(const limb_t* a, const limb_t* b, std::size_t length)
+	{
+		// from the most significant end, the first block with a difference decides
+		std::size_t i = length;
+		for (; i >= 8; i -= 8) {
+			__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i - 8));
+			__m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i - 8));
+			unsigned equal = lane_mask_avx2(_mm256_cmpeq_epi32(x, y));
+			if (equal == 0xFF)
+				continue;
+
+			// highest lane with a difference
+			unsigned different = ~equal & 0xFF;
+			std::size_t lane = 0;
+			while (different >>= 1)
+				lane++;
+			std::size_t index = i - 8 + lane;
+			return a[index] < b[index] ? CMP_SECOND_PARAMETER_BIGGER : CMP_SECOND_PARAMETER_SMALLER;
+		}
+
+		return cmp_n_portable(a, b, i);
+	}
+
+	BIGINT_TARGET("avx2")
+	limb_t mul_add_small_n_avx2(limb_t* limbs, std::size_t length, limb_t factor, limb_t carry)
+	{
+		const __m256i factors = _mm256_set1_epi32(static_cast<int>(factor));
+		const __m256i rotate_up = _mm256_setr_epi32(7, 0, 1, 2, 3, 4, 5, 6);
+
+		std::size_t i = 0;
+		for (; i + 8 <= length; i += 8) {
+			__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(limbs + i));
+
+			// 64 bit products of the even and the odd lanes
+			__m256i even = _mm256_mul_epu32(x, factors);
+			__m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), factors);
+			__m256i low = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+			__m256i high = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+
+			// every high half belongs to the next lane, the carry of the previous step goes into lane 0
+			__m256i shifted_high = _mm256_permutevar8x32_epi32(high, rotate_up);
+			limb_t top_high = static_cast<limb_t>(_mm256_extract_epi32(shifted_high, 0));
+			shifted_high = _mm256_blend_epi32(shifted_high, _mm256_set1_epi32(static_cast<int>(carry)), 1);
+
+			unsigned lane_carry = 0;
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(limbs + i), add_lanes_avx2(low, shifted_high, lane_carry));
+
+			// cannot overflow, the high half of a product is at most 2^32 - 2
+			carry = top_high + lane_carry;
+		}
+
+		return mul_add_small_n_portable(limbs + i, length - i, factor, carry);
+	}
+
+	// -----------------------
+	// -- AVX-512 kernels, 16 limbs per step
+	// -----------------------
+	// same scheme as above, the masks come straight from the compare instructions
+
+	// the avx512 headers of gcc 12 trip -Wmaybe-uninitialized on their own placeholder values
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+	BIGINT_TARGET("avx512f")
+	static __m512i add_lanes_avx512(__m512i a, __m512i b, unsigned& carry)
+	{
+		__m512i sum = _mm512_add_epi32(a, b);
+		unsigned generate = _mm512_cmplt_epu32_mask(sum, a);
+		unsigned propagate = _mm512_cmpeq_epi32_mask(sum, _mm512_set1_epi32(-1));
+
+		unsigned carries = (((generate << 1) | carry) + propagate) ^ propagate;
+		carry = carries >> 16;
+		return _mm512_mask_add_epi32(sum, static_cast<__mmask16>(carries), sum, _mm512_set1_epi32(1));
+	}
+
+	BIGINT_TARGET("avx512f")
+	limb_t add_n_avx512(limb_t* destination, const limb_t* a, const limb_t* b, std::size_t length, limb_t carry)
+	{
+		unsigned lane_carry = carry;
+		std::size_t i = 0;
+		for (; i + 16 <= length; i += 16) {
+			__m512i x = _mm512_loadu_si512(a + i);
+			__m512i y = _mm512_loadu_si512(b + i);
+			_mm512_storeu_si512(destination + i, add_lanes_avx512(x, y, lane_carry));
+		}
+
+		return add_n_portable(destination + i, a + i, b + i, length - i, lane_carry);
+	}
+
+	BIGINT_TARGET("avx512f")
+	limb_t sub_n_avx512(limb_t* destination, const limb_t* a, const limb_t* b, std::size_t length, limb_t borrow)
+	{
+		unsigned lane_borrow = borrow;
+		std::size_t i = 0;
+		for (; i + 16 <= length; i += 16) {
+			__m512i x = _mm512_loadu_si512(a + i);
+			__m512i y = _mm512_loadu_si512(b + i);
+			__m512i difference = _mm512_sub_epi32(x, y);
+			unsigned generate = _mm512_cmplt_epu32_mask(x, y);
+			unsigned propagate = _mm512_cmpeq_epi32_mask(difference, _mm512_setzero_si512());
+
+			unsigned borrows = (((generate << 1) | lane_borrow) + propagate) ^ propagate;
+			lane_borrow = borrows >> 16;
+			difference = _mm512_mask_sub_epi32(difference, static_cast<__mmask16>(borrows), difference, _mm512_set1_epi32(1));
+			_mm512_storeu_si512(destination + i, difference);
+		}
+
+		return sub_n_portable(destination + i, a + i, b + i, length - i, lane_borrow);
+	}
+
+	BIGINT_TARGET("avx512f")
+	short cmp_n_avx512(const limb_t* a, const limb_t* b, std::size_t length)
+	{
+		std::size_t i = length;
+		for (; i >= 16; i -= 16) {
+			__m512i x = _mm512_loadu_si512(a + i - 16);
+			__m512i y = _mm512_loadu_si512(b + i - 16);
+			unsigned different = _mm512_cmpneq_epi32_mask(x, y);
+			if (different == 0)
+				continue;
+
+			std::size_t lane = 0;
+			while (different >>= 1)
+				lane++;
+			std::size_t index = i - 16 + lane;
+			return a[index] < b[index] ? CMP_SECOND_PARAMETER_BIGGER : CMP_SECOND_PARAMETER_SMALLER;
+		}
+
+		return cmp_n_portable(a, b, i);
+	}
+
+	BIGINT_TARGET("avx512f")
+	limb_t mul_add_small_n_avx512(limb_t* limbs, std::size_t length, limb_t factor, limb_t carry)
+	{
+		const __m512i factors = _mm512_set1_epi32(static_cast<int>(factor));
+		const __m512i rotate_up = _mm512_setr_epi32(15, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14);
+		const __mmask16 odd_lanes = 0xAAAA;
+
+		std::size_t i = 0;
+		for (; i + 16 <= length; i += 16) {
+			__m512i x = _mm512_loadu_si512(limbs + i);
+
+			__m512i even = _mm512_mul_epu32(x, factors);
+			__m512i odd = _mm512_mul_epu32(_mm512_srli_epi64(x, 32), factors);
+			__m512i low = _mm512_mask_blend_epi32(odd_lanes, even, _mm512_slli_epi64(odd, 32));
+			__m512i high = _mm512_mask_blend_epi32(odd_lanes, _mm512_srli_epi64(even, 32), odd);
+
+			__m512i shifted_high = _mm512_permutexvar_epi32(rotate_up, high);
+			limb_t top_high = static_cast<limb_t>(_mm_cvtsi128_si32(_mm512_castsi512_si128(shifted_high)));
+			shifted_high = _mm512_mask_set1_epi32(shifted_high, 1, static_cast<int>(carry));
+
+			unsigned lane_carry = 0;
+			_mm512_storeu_si512(limbs + i, add_lanes_avx512(low, shifted_high, lane_carry));
+			carry = top_high + lane_carry;
+		}
+
+		return mul_add_small_n_portable(limbs + i, length - i, factor, carry);
+	}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+}
@@ -0,0 +1,164 @@
+#include "BigIntLimbs.h"
+
+#include <algorithm>
+
+using namespace bigint_limbs;
+
+// -----------------------
+// -- Internal counters per thread
+// -----------------------
+
+namespace bigint_limbs
+{
+	// only the owning thread writes, snapshots of other threads read, so relaxed atomics are enough
+	struct AtomicCounters
+	{
+		std::atomic<std::uint64_t> calls{ 0 };
+		std::atomic<std::uint64_t> limbs{ 0 };
+		std::atomic<std::uint64_t> allocations{ 0 };
+		std::atomic<std::uint64_t> allocated_bytes{ 0 };
+		std::atomic<std::uint64_t> nanoseconds{ 0 };
+	};
+
+	static void add_counters(BigIntStats::Counters& sum, const AtomicCounters& counters)
+	{
+		sum.calls += counters.calls.load(std::memory_order_relaxed);
+		sum.limbs += counters.limbs.load(std::memory_order_relaxed);
+		sum.allocations += counters.allocations.load(std::memory_order_relaxed);
+		sum.allocated_bytes += counters.allocated_bytes.load(std::memory_order_relaxed);
+		sum.nanoseconds += counters.nanoseconds.load(std::memory_order_relaxed);
+	}
+
+	struct ThreadCounters;
+
+	// the counters of the running threads and the sums of the ended ones
+	// reset only moves the baseline, so it never races with the threads writing their counters
+	struct Registry
+	{
+		std::mutex mutex;
+		std::vector<ThreadCounters*> threads;
+		BigIntStats ended{};
+		BigIntStats baseline{};
+	};
+
+	static Registry& registry()
+	{
+		static Registry instance;
+		return instance;
+	}
+
+	struct ThreadCounters
+	{
+		AtomicCounters operations[BigIntStats::OP_COUNT];
+		// innermost scope of the thread
+		BigIntStats::Operation current = BigIntStats::OP_OTHER;
+
+		ThreadCounters()
+		{
+			std::lock_guard<std::mutex> lock(registry().mutex);
+			registry().threads.push_back(this);
+		}
+
+		// the counts of an ending thread stay in the totals
+		~ThreadCounters()
+		{
+			std::lock_guard<std::mutex> lock(registry().mutex);
+			add_to(registry().ended);
+			std::vector<ThreadCounters*>& threads = registry().threads;
+			threads.erase(std::find(threads.begin(), threads.end(), this));
+		}
+
+		void add_to(BigIntStats& sum) const
+		{
+			for (int i = 0; i < BigIntStats::OP_COUNT; i++)
+				add_counters(sum.operations[i], operations[i]);
+		}
+	};
+
+#if defined(BIGINT_STATS)
+	// a plain load and store, no locked instruction, as there is a single writer
+	static void add_counter(std::atomic<std::uint64_t>& counter, std::uint64_t value)
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+
+	static ThreadCounters& thread_counters()
+	{
+		static thread_local ThreadCounters counters;
+		return counters;
+	}
+#endif
+
+	// sum of all threads since the start of the program, registry().mutex has to be locked
+	static BigIntStats total()
+	{
+		BigIntStats sum = registry().ended;
+		for (const ThreadCounters* counters : registry().threads)
+			counters->add_to(sum);
+		return sum;
+	}
+}
+
+// -----------------------
+// -- Snapshot
+// -----------------------
+
+const char* BigIntStats::operation_name(Operation operation)
+{
+	static const char* const names[OP_COUNT] = { "add", "sub", "mul", "div", "cmp", "to_string", "from_string", "grow", "other" };
+	return operation >= 0 && operation < OP_COUNT ? names[operation] : "unknown";
+}
+
+BigIntStats BigIntStats::snapshot()
+{
+	std::lock_guard<std::mutex> lock(registry().mutex);
+	BigIntStats stats = total();
+	const BigIntStats& baseline = registry().baseline;
+	for (int i = 0; i < OP_COUNT; i++) {
+		stats.operations[i].calls -= baseline.operations[i].calls;
+		stats.operations[i].limbs -= baseline.operations[i].limbs;
+		stats.operations[i].allocations -= baseline.operations[i].allocations;
+		stats.operations[i].allocated_bytes -= baseline.operations[i].allocated_bytes;
+		stats.operations[i].nanoseconds -= baseline.operations[i].nanoseconds;
+	}
+	return stats;
+}
+
+void BigIntStats::reset()
+{
+	std::lock_guard<std::mutex> lock(registry().mutex);
+	registry().baseline = total();
+}
+
+// -----------------------
+// -- Counting
+// -----------------------
+
+#if defined(BIGINT_STATS)
+namespace bigint_limbs
+{
+	StatsScope::StatsScope(BigIntStats::Operation operation, std::size_t limbs) : operation(operation), start(std::chrono::steady_clock::now())
+	{
+		ThreadCounters& counters = thread_counters();
+		previous = counters.current;
+		counters.current = operation;
+		add_counter(counters.operations[operation].calls, 1);
+		add_counter(counters.operations[operation].limbs, limbs);
+	}
+
+	StatsScope::~StatsScope()
+	{
+		ThreadCounters& counters = thread_counters();
+		std::chrono::nanoseconds duration = std::chrono::steady_clock::now() - start;
+		add_counter(counters.operations[operation].nanoseconds, static_cast<std::uint64_t>(duration.count()));
+		counters.current = previous;
+	}
+
+	void count_allocation(std::size_t bytes)
+	{
+		ThreadCounters& counters = thread_counters();
+		add_counter(counters.operations[counters.current].allocations, 1);
+		add_counter(counters.operations[counters.current].allocated_bytes, bytes);
+	}
+}
+#endif
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// counters of the BigInt operations, for finding out where the time of a slow job goes
+// they are only collected when the library is compiled with BIGINT_STATS defined,
+// otherwise the counting compiles to nothing and every snapshot is zero
+// every thread counts into its own counters, a snapshot adds up all threads
+class BigIntStats
+{
+	public:
+		enum Operation
+		{
+			// += and -=, also inside operator+ and operator-
+			OP_ADD,
+			OP_SUB,
+			// all multiplications, including the fused a + b * c
+			OP_MUL,
+			// division and remainder
+			OP_DIV,
+			OP_CMP,
+			// to_string, to_chars and operator<<
+			OP_TO_STRING,
+			// from_chars and from_string
+			OP_FROM_STRING,
+			// reallocation of a BigInt buffer which became too small, nested inside the operation that grew it
+			OP_GROW,
+			// allocations outside of the operations above, e.g. copies
+			OP_OTHER,
+			OP_COUNT
+		};
+
+		struct Counters
+		{
+			std::uint64_t calls;
+			// operand limbs, for add, sub and cmp the longer operand, for mul both and for div the dividend
+			std::uint64_t limbs;
+			// heap allocations of BigInt buffers and scratch buffers while the operation ran
+			std::uint64_t allocations;
+			std::uint64_t allocated_bytes;
+			// wall time including nested operations, e.g. the growth inside an add
+			std::uint64_t nanoseconds;
+		};
+
+		Counters operations[OP_COUNT];
+
+		static constexpr bool is_enabled =
+#if defined(BIGINT_STATS)
+			true;
+#else
+			false;
+#endif
+
+		// lower case name of an operation for reports, e.g. "mul"
+		static const char* operation_name(Operation operation);
+
+		// sum of the counters of all threads since the last reset, including threads which already ended
+		static BigIntStats snapshot();
+
+		// starts all counters from zero again, other threads may keep counting while it runs
+		static void reset();
+};
@@ -0,0 +1,161 @@
+#include "BigIntLimbs.h"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+// -----------------------
+// -- Tunable thresholds
+// -----------------------
+
+std::size_t BigInt::conversion_threshold = 32;
+
+namespace bigint_limbs
+{
+	// -----------------------
+	// -- Internal Constants for decimal conversion
+	// -----------------------
+
+	// a level that divides this many numbers by its power computes the reciprocal once and reuses it
+	// huge powers always keep it, newton division would compute it anyway
+	const std::size_t RECIPROCAL_MIN_DIVISIONS = 4;
+
+	// -----------------------
+	// -- Internal Util functions
+	// -----------------------
+
+	// repeated short division, writes the chunks of a and returns their count
+	// a is used as scratch space and left as zero
+	static std::size_t to_chunks_small(limb_t* chunks, limb_t* a, std::size_t a_length)
+	{
+		std::size_t count = 0;
+		a_length = trimmed_length(a, a_length);
+		while (a_length > 0) {
+			chunks[count++] = div_small(a, a_length, DECIMAL_CHUNK_BASE);
+			a_length = trimmed_length(a, a_length);
+		}
+
+		return count;
+	}
+
+	// writes exactly 2^(level + 1) chunks, a has to be smaller than DECIMAL_CHUNK_BASE^(2^(level + 1))
+	// a = high * DECIMAL_CHUNK_BASE^(2^level) + low, both halves are converted recursively
+	// the conversion started at top_level, so there are up to 2^(top_level - level) divisions on this level
+	static void to_chunks(limb_t* chunks, limb_t* a, std::size_t a_length, std::size_t level, std::size_t top_level)
+	{
+		std::size_t chunk_count = std::size_t(2) << level;
+		std::size_t half = chunk_count / 2;
+		a_length = trimmed_length(a, a_length);
+
+		if (level == 0 || a_length <= BigInt::conversion_threshold) {
+			std::size_t count = to_chunks_small(chunks, a, a_length);
+			std::fill(chunks + count, chunks + chunk_count, 0);
+			return;
+		}
+
+		const std::vector<limb_t>& power = decimal_power(level).power;
+		std::size_t power_length = power.size();
+		if (a_length < power_length) {
+			// the upper half is all zeros
+			std::fill(chunks + half, chunks + chunk_count, 0);
+			to_chunks(chunks, a, a_length, level - 1, top_level);
+			return;
+		}
+
+		limb_vector high(a_length - power_length + 1);
+		limb_vector low(power_length);
+		std::size_t division_count = std::size_t(1) << (top_level - level);
+		if (power_length >= BigInt::newton_division_threshold || division_count >= RECIPROCAL_MIN_DIVISIONS) {
+			const DecimalPower& entry = decimal_power(level, true);
+			divmod_preinverted(high.data(), low.data(), a, a_length, entry.normalized.data(), power_length, entry.shift, entry.reciprocal.data());
+		}
+		else {
+			divmod(high.data(), low.data(), a, a_length, power.data(), power_length);
+		}
+		to_chunks(chunks + half, high.data(), high.size(), level - 1, top_level);
+		to_chunks(chunks, low.data(), low.size(), level - 1, top_level);
+	}
+
+	// destination gets limbs_for_decimal_chunks(chunk_count) limbs
+	// the lower 2^level chunks and the rest are converted recursively and joined by one multiplication
+	static void from_chunks(limb_t* destination, const limb_t* chunks, std::size_t chunk_count)
+	{
+		std::size_t destination_length = limbs_for_decimal_chunks(chunk_count);
+		std::fill(destination, destination + destination_length, 0);
+
+		if (chunk_count <= BigInt::conversion_threshold) {
+			std::size_t length = 0;
+			for (std::size_t i = chunk_count; i-- > 0;) {
+				limb_t carry = mul_add_small(destination, length, DECIMAL_CHUNK_BASE, chunks[i]);
+				if (carry > 0)
+					destination[length++] = carry;
+			}
+			return;
+		}
+
+		// biggest power of two below chunk_count
+		std::size_t level = 0;
+		std::size_t half = 1;
+		while (2 * half < chunk_count) {
+			half *= 2;
+			level++;
+		}
+
+		limb_vector high(limbs_for_decimal_chunks(chunk_count - half));
+		from_chunks(high.data(), chunks + half, chunk_count - half);
+		limb_vector low(limbs_for_decimal_chunks(half));
+		from_chunks(low.data(), chunks, half);
+
+		std::size_t high_length = trimmed_length(high.data(), high.size());
+		std::size_t low_length = trimmed_length(low.data(), low.size());
+		if (high_length > 0) {
+			const std::vector<limb_t>& power = decimal_power(level).power;
+			assert(high_length + power.size() <= destination_length);
+			mul(destination, high.data(), high_length, power.data(), power.size());
+		}
+
+		limb_t carry = add(destination, destination, destination_length, low.data(), low_length);
+		assert(carry == 0);
+		(void)carry;
+	}
+
+	// -----------------------
+	// -- Decimal conversion
+	// -----------------------
+
+	std::size_t limbs_for_decimal_chunks(std::size_t chunk_count)
+	{
+		// one chunk carries log2(10^9) = 29.9 bits, a bit less than 15/16 of a limb
+		// the two extra limbs cover the rounding of both factors in from_chunks
+		return chunk_count - chunk_count / 16 + 2;
+	}
+
+	limb_vector to_decimal_chunks(const limb_t* a, std::size_t a_length)
+	{
+		a_length = trimmed_length(a, a_length);
+		limb_vector scratch(a, a + a_length);
+
+		if (a_length <= BigInt::conversion_threshold) {
+			// one limb holds less than 1.1 chunks
+			limb_vector chunks(a_length + a_length / 8 + 1);
+			chunks.resize(to_chunks_small(chunks.data(), scratch.data(), a_length));
+			return chunks;
+		}
+
+		// smallest level whose 2^(level + 1) chunks can hold a
+		std::size_t level = 0;
+		while (decimal_power(level + 1).power.size() <= a_length)
+			level++;
+
+		limb_vector chunks(std::size_t(2) << level);
+		to_chunks(chunks.data(), scratch.data(), a_length, level, level);
+		chunks.resize(trimmed_length(chunks.data(), chunks.size()));
+		return chunks;
+	}
+
+	std::size_t from_decimal_chunks(limb_t* destination, const limb_t* chunks, std::size_t chunk_count)
+	{
+		from_chunks(destination, chunks, chunk_count);
+		return trimmed_length(destination, limbs_for_decimal_chunks(chunk_count));
+	}
+}
@@ -0,0 +1,160 @@
+#include "BigIntView.h"
+#include "BigIntLimbs.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+using namespace bigint_limbs;
+
+// -----------------------
+// -- Internal Util functions for the wire format
+// -----------------------
+
+static bool is_little_endian()
+{
+	limb_t one = 1;
+	unsigned char first_byte;
+	memcpy(&first_byte, &one, 1);
+	return first_byte == 1;
+}
+
+static void write_little_endian(unsigned char* destination, std::uint64_t value, std::size_t bytes)
+{
+	for (std::size_t i = 0; i < bytes; i++)
+		destination[i] = static_cast<unsigned char>(value >> (8 * i));
+}
+
+static std::uint64_t read_little_endian(const unsigned char* source, std::size_t bytes)
+{
+	std::uint64_t value = 0;
+	for (std::size_t i = 0; i < bytes; i++)
+		value |= static_cast<std::uint64_t>(source[i]) << (8 * i);
+	return value;
+}
+
+// checks the header and returns the number of limbs behind it, is_negative gets the sign
+// returns false if data is too short or not a canonical number of this version
+static bool read_header(const unsigned char* data, std::size_t size, std::size_t& length, bool& is_negative)
+{
+	if (size < SERIALIZED_HEADER_SIZE || data[0] != SERIALIZATION_VERSION || data[1] > 1 || data[2] != 0 || data[3] != 0)
+		return false;
+
+	std::uint64_t limb_count = read_little_endian(data + 4, 8);
+	if (limb_count > (size - SERIALIZED_HEADER_SIZE) / sizeof(limb_t))
+		return false;
+
+	length = static_cast<std::size_t>(limb_count);
+	is_negative = data[1] == 1;
+
+	// serialize writes no negative zero and no leading zero limb
+	if (length == 0)
+		return !is_negative;
+	return read_little_endian(data + SERIALIZED_HEADER_SIZE + (length - 1) * sizeof(limb_t), sizeof(limb_t)) != 0;
+}
+
+// -----------------------
+// -- View
+// -----------------------
+
+BigIntView::BigIntView(const limb_t* limbs, std::size_t length, bool is_negative) : limbs(limbs), length(trimmed_length(limbs, length)), is_negative(is_negative)
+{
+	// takes care of -0
+	if (this->length == 0)
+		this->is_negative = false;
+}
+
+short BigIntView::cmp_absolute(const BigIntView& b) const
+{
+	return bigint_limbs::cmp(limbs, length, b.limbs, b.length);
+}
+
+short BigIntView::cmp(const BigIntView& b) const
+{
+	BIGINT_STATS_SCOPE(OP_CMP, std::max(length, b.length));
+
+	if (is_negative != b.is_negative)
+		return is_negative ? CMP_SECOND_PARAMETER_BIGGER : CMP_SECOND_PARAMETER_SMALLER;
+
+	// both have the same sign, for negative numbers the bigger absolute value is the smaller number
+	short cmp_result = cmp_absolute(b);
+	return is_negative ? -cmp_result : cmp_result;
+}
+
+// -----------------------
+// -- Wire format
+// -----------------------
+
+std::size_t serialized_size(const BigIntView& b)
+{
+	return SERIALIZED_HEADER_SIZE + b.get_length() * sizeof(limb_t);
+}
+
+std::size_t serialize(const BigIntView& b, unsigned char* buffer, std::size_t size)
+{
+	std::size_t total_size = serialized_size(b);
+	if (size < total_size)
+		return 0;
+
+	buffer[0] = SERIALIZATION_VERSION;
+	buffer[1] = b.get_is_negative() ? 1 : 0;
+	buffer[2] = 0;
+	buffer[3] = 0;
+	write_little_endian(buffer + 4, b.get_length(), 8);
+
+	unsigned char* destination = buffer + SERIALIZED_HEADER_SIZE;
+	if (is_little_endian()) {
+		if (b.get_length() > 0)
+			memcpy(destination, b.get_limbs(), b.get_length() * sizeof(limb_t));
+	}
+	else {
+		for (std::size_t i = 0; i < b.get_length(); i++)
+			write_little_endian(destination + i * sizeof(limb_t), b.get_limbs()[i], sizeof(limb_t));
+	}
+
+	return total_size;
+}
+
+std::vector<unsigned char> serialize(const BigIntView& b)
+{
+	std::vector<unsigned char> buffer(serialized_size(b));
+	serialize(b, buffer.data(), buffer.size());
+	return buffer;
+}
+
+std::size_t deserialize(const unsigned char* data, std::size_t size, BigInt& b)
+{
+	std::size_t length;
+	bool is_negative;
+	if (!read_header(data, size, length, is_negative))
+		return 0;
+
+	// the old value is not needed, so nothing is copied when the buffer grows
+	b.length = 0;
+	b.ensure_capacity(length);
+
+	const unsigned char* source = data + SERIALIZED_HEADER_SIZE;
+	if (is_little_endian()) {
+		if (length > 0)
+			memcpy(b.limbs, source, length * sizeof(limb_t));
+	}
+	else {
+		for (std::size_t i = 0; i < length; i++)
+			b.limbs[i] = static_cast<limb_t>(read_little_endian(source + i * sizeof(limb_t), sizeof(limb_t)));
+	}
+
+	b.length = length;
+	b.is_negative = is_negative;
+	return SERIALIZED_HEADER_SIZE + length * sizeof(limb_t);
+}
+
+std::size_t view_serialized(const unsigned char* data, std::size_t size, BigIntView& view)
+{
+	std::size_t length;
+	bool is_negative;
+	if (!is_little_endian() || reinterpret_cast<std::uintptr_t>(data) % alignof(limb_t) != 0 || !read_header(data, size, length, is_negative))
+		return 0;
+
+	view = BigIntView(reinterpret_cast<const limb_t*>(data + SERIALIZED_HEADER_SIZE), length, is_negative);
+	return SERIALIZED_HEADER_SIZE + length * sizeof(limb_t);
+}
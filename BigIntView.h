@@ -0,0 +1,89 @@
+#pragma once
+
+#include "BigInt.h"
+
+#include <cstddef>
+#include <vector>
+
+// a read-only number on limbs owned by someone else: a BigInt, a serialized buffer or a memory mapped file
+// nothing is copied, so the limbs have to stay alive and unchanged while the view is used
+// it works with the const operations and as right operand of the arithmetic operators of BigInt
+class BigIntView
+{
+	public:
+		typedef BigInt::limb_t limb_t;
+
+		// zero
+		BigIntView() : limbs(nullptr), length(0), is_negative(false) {}
+
+		// length limbs, least significant limb first, leading zero limbs are ignored
+		BigIntView(const limb_t* limbs, std::size_t length, bool is_negative);
+
+		// implicit, so a BigInt can be used wherever a view is expected
+		BigIntView(const BigInt& b) : limbs(b.limbs), length(b.length), is_negative(b.is_negative) {}
+
+		const limb_t* get_limbs() const { return limbs; }
+		std::size_t get_length() const { return length; }
+		bool get_is_negative() const { return is_negative; }
+
+		// compares two views
+		// returns number > 0 if b is bigger
+		// returns number < 0 if b is smaller
+		// returns 0 if numbers are equals
+		short cmp(const BigIntView& b) const;
+
+		// compares the absolute values (sign will be ignored), same result as cmp
+		short cmp_absolute(const BigIntView& b) const;
+
+		// also used for a BigInt compared with a view, the BigInt is viewed and not copied
+		friend bool operator==(const BigIntView& b1, const BigIntView& b2) { return b1.cmp(b2) == 0; }
+		friend bool operator!=(const BigIntView& b1, const BigIntView& b2) { return b1.cmp(b2) != 0; }
+		friend bool operator<=(const BigIntView& b1, const BigIntView& b2) { return b1.cmp(b2) >= 0; }
+		friend bool operator>=(const BigIntView& b1, const BigIntView& b2) { return b1.cmp(b2) <= 0; }
+		friend bool operator<(const BigIntView& b1, const BigIntView& b2) { return b1.cmp(b2) > 0; }
+		friend bool operator>(const BigIntView& b1, const BigIntView& b2) { return b1.cmp(b2) < 0; }
+
+		// the view as right operand, the result is a new BigInt
+		friend BigInt operator+(BigInt b1, const BigIntView& b2) { b1 += b2; return b1; }
+		friend BigInt operator-(BigInt b1, const BigIntView& b2) { b1 -= b2; return b1; }
+		friend BigInt operator*(BigInt b1, const BigIntView& b2) { b1 *= b2; return b1; }
+		friend BigInt operator/(BigInt b1, const BigIntView& b2) { b1 /= b2; return b1; }
+		friend BigInt operator%(BigInt b1, const BigIntView& b2) { b1 %= b2; return b1; }
+
+		friend std::ostream& operator<<(std::ostream& os, const BigIntView& b) { return os << BigInt(b); }
+
+	private:
+		// least significant limb first, no leading zero limbs, nullptr for zero
+		const limb_t* limbs;
+		std::size_t length;
+		bool is_negative;
+};
+
+// -----------------------
+// -- Wire format
+// -----------------------
+// version 1, all numbers little endian:
+//   byte 0        format version
+//   byte 1        1 for negative numbers, 0 otherwise
+//   bytes 2-3     zero
+//   bytes 4-11    number of limbs n, without leading zero limbs
+//   bytes 12-     n limbs of 4 bytes, least significant limb first
+// the limbs start at a multiple of 4 bytes, so a view can use them in place on little endian machines
+
+const unsigned char SERIALIZATION_VERSION = 1;
+const std::size_t SERIALIZED_HEADER_SIZE = 12;
+
+// number of bytes serialize writes for b
+std::size_t serialized_size(const BigIntView& b);
+
+// writes b into buffer, returns the number of bytes written or 0 if size is too small
+std::size_t serialize(const BigIntView& b, unsigned char* buffer, std::size_t size);
+std::vector<unsigned char> serialize(const BigIntView& b);
+
+// reads a number written by serialize into b and returns the number of bytes read
+// returns 0 and leaves b unchanged if data does not start with a valid number of this version
+std::size_t deserialize(const unsigned char* data, std::size_t size, BigInt& b);
+
+// like deserialize, but view points straight at the limbs in data instead of copying them
+// this needs data aligned for BigInt::limb_t and a little endian machine, otherwise it returns 0 and deserialize has to be used
+std::size_t view_serialized(const unsigned char* data, std::size_t size, BigIntView& view);
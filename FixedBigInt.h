@@ -0,0 +1,237 @@
+#pragma once
+
+#include "BigInt.h"
+
+#include <cassert>
+#include <cstddef>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+
+namespace bigint_limbs
+{
+	// quotient = a / b and remainder = a % b of two limb arrays with length limbs each, b must not be zero
+	// works only in scratch, which needs 3 * length + 1 limbs, so it never allocates
+	void divmod_fixed(BigInt::limb_t* quotient, BigInt::limb_t* remainder, const BigInt::limb_t* a, const BigInt::limb_t* b, std::size_t length, BigInt::limb_t* scratch);
+}
+
+// a signed number of at most Bits bits stored inside the object, for values with a known maximum width like 256 or 512 bits
+// same operators and comparisons as BigInt, but without heap buffer, length or capacity
+// add, subtract, multiply and compare always run over all limbs with loops unrolled at compile time
+// every result should fit into Bits bits, debug builds check that with assert
+// release builds do not check, the magnitude of a result that is too big wraps around modulo 2^Bits and keeps its sign
+template <unsigned Bits>
+class FixedBigInt
+{
+	static_assert(Bits > 0 && Bits % BigInt::LIMB_BITS == 0, "Bits has to be a multiple of the limb size");
+
+	public:
+		typedef BigInt::limb_t limb_t;
+		typedef BigInt::double_limb_t double_limb_t;
+
+		static constexpr std::size_t LIMBS = Bits / BigInt::LIMB_BITS;
+
+		FixedBigInt() : is_negative(false), limbs{} {}
+
+		FixedBigInt(long int value) : is_negative(value < 0), limbs{}
+		{
+			// the magnitude of the smallest long does not fit into a long
+			unsigned long long magnitude = value < 0 ? 0 - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+			std::size_t i = 0;
+			for (; magnitude > 0 && i < LIMBS; i++, magnitude >>= BigInt::LIMB_BITS)
+				limbs[i] = static_cast<limb_t>(magnitude);
+			assert(magnitude == 0);
+			normalize_sign();
+		}
+
+		// the value of b has to fit into Bits bits
+		explicit FixedBigInt(const BigInt& b) : is_negative(b.is_negative), limbs{}
+		{
+			assert(b.length <= LIMBS);
+			for (std::size_t i = 0; i < b.length && i < LIMBS; i++)
+				limbs[i] = b.limbs[i];
+			normalize_sign();
+		}
+
+		// copies the limbs into a new BigInt
+		operator BigInt() const
+		{
+			std::size_t length = LIMBS;
+			while (length > 0 && limbs[length - 1] == 0)
+				length--;
+
+			BigInt result(length, is_negative, BigInt::default_resource());
+			for (std::size_t i = 0; i < length; i++)
+				result.limbs[i] = limbs[i];
+			return result;
+		}
+
+		// compares two FixedBigInts
+		// returns number > 0 if b is bigger
+		// returns number < 0 if b is smaller
+		// returns 0 if numbers are equals
+		short cmp(const FixedBigInt& b) const
+		{
+			if (is_negative != b.is_negative)
+				return is_negative ? 1 : -1;
+
+			// for negative numbers the bigger absolute value is the smaller number
+			short cmp_result = cmp_absolute(b);
+			return is_negative ? -cmp_result : cmp_result;
+		}
+
+		// compares the absolute values, same result as cmp
+		short cmp_absolute(const FixedBigInt& b) const
+		{
+			// walks up from the lowest limb, so the highest differing limb decides without a loop exit
+			short cmp_result = 0;
+			unroll<LIMBS>([&](auto i) {
+				if (limbs[i] != b.limbs[i])
+					cmp_result = limbs[i] < b.limbs[i] ? 1 : -1;
+			});
+			return cmp_result;
+		}
+
+		FixedBigInt& operator += (const FixedBigInt& b) { add_signed(b, b.is_negative); return *this; }
+		FixedBigInt& operator -= (const FixedBigInt& b) { add_signed(b, !b.is_negative); return *this; }
+
+		FixedBigInt& operator *= (const FixedBigInt& b)
+		{
+			// only the lower LIMBS limbs of the schoolbook product are computed, row i needs LIMBS - i of them
+			limb_t product[LIMBS] = {};
+			unroll<LIMBS>([&](auto i) {
+				double_limb_t carry = 0;
+				unroll<LIMBS - decltype(i)::value>([&](auto j) {
+					double_limb_t current = static_cast<double_limb_t>(limbs[i]) * b.limbs[j] + product[i + j] + carry;
+					product[i + j] = static_cast<limb_t>(current);
+					carry = current >> BigInt::LIMB_BITS;
+				});
+				assert(carry == 0);
+			});
+			assert(fits_product(b));
+
+			is_negative = is_negative != b.is_negative;
+			unroll<LIMBS>([&](auto i) { limbs[i] = product[i]; });
+			normalize_sign();
+			return *this;
+		}
+
+		// truncated towards zero like BigInt, the remainder has the sign of the dividend
+		// the scratch of the division lives on the stack like the limbs, so it does not allocate either
+		FixedBigInt& operator /= (const FixedBigInt& b)
+		{
+			limb_t remainder[LIMBS];
+			limb_t scratch[DIVISION_SCRATCH_LIMBS];
+			bigint_limbs::divmod_fixed(limbs, remainder, limbs, b.limbs, LIMBS, scratch);
+			is_negative = is_negative != b.is_negative;
+			normalize_sign();
+			return *this;
+		}
+
+		FixedBigInt& operator %= (const FixedBigInt& b)
+		{
+			limb_t quotient[LIMBS];
+			limb_t scratch[DIVISION_SCRATCH_LIMBS];
+			bigint_limbs::divmod_fixed(quotient, limbs, limbs, b.limbs, LIMBS, scratch);
+			normalize_sign();
+			return *this;
+		}
+
+		friend FixedBigInt operator+(FixedBigInt b1, const FixedBigInt& b2) { return b1 += b2; }
+		friend FixedBigInt operator-(FixedBigInt b1, const FixedBigInt& b2) { return b1 -= b2; }
+		friend FixedBigInt operator*(FixedBigInt b1, const FixedBigInt& b2) { return b1 *= b2; }
+		friend FixedBigInt operator/(FixedBigInt b1, const FixedBigInt& b2) { return b1 /= b2; }
+		friend FixedBigInt operator%(FixedBigInt b1, const FixedBigInt& b2) { return b1 %= b2; }
+
+		friend bool operator==(const FixedBigInt& b1, const FixedBigInt& b2) { return b1.cmp(b2) == 0; }
+		friend bool operator!=(const FixedBigInt& b1, const FixedBigInt& b2) { return b1.cmp(b2) != 0; }
+		friend bool operator<=(const FixedBigInt& b1, const FixedBigInt& b2) { return b1.cmp(b2) >= 0; }
+		friend bool operator>=(const FixedBigInt& b1, const FixedBigInt& b2) { return b1.cmp(b2) <= 0; }
+		friend bool operator<(const FixedBigInt& b1, const FixedBigInt& b2) { return b1.cmp(b2) > 0; }
+		friend bool operator>(const FixedBigInt& b1, const FixedBigInt& b2) { return b1.cmp(b2) < 0; }
+
+		friend std::ostream& operator<<(std::ostream& os, const FixedBigInt& b)
+		{
+			return os << BigInt(b);
+		}
+
+	private:
+		// zero is never negative
+		bool is_negative;
+		// least significant limb first like BigInt, the unused high limbs are zero
+		limb_t limbs[LIMBS];
+
+		static constexpr std::size_t DIVISION_SCRATCH_LIMBS = 3 * LIMBS + 1;
+
+		// calls function with std::integral_constant<std::size_t, 0> up to Count - 1, one call after the other without a loop
+		template <std::size_t Count, typename Function>
+		static void unroll(Function&& function)
+		{
+			unroll(function, std::make_index_sequence<Count>());
+		}
+
+		template <typename Function, std::size_t... Indices>
+		static void unroll(Function& function, std::index_sequence<Indices...>)
+		{
+			(function(std::integral_constant<std::size_t, Indices>()), ...);
+		}
+
+		bool is_zero() const
+		{
+			limb_t any = 0;
+			unroll<LIMBS>([&](auto i) { any |= limbs[i]; });
+			return any == 0;
+		}
+
+		void normalize_sign()
+		{
+			is_negative = is_negative && !is_zero();
+		}
+
+		// adds b with the given sign in place, shared by += and -=
+		void add_signed(const FixedBigInt& b, bool b_is_negative)
+		{
+			if (is_negative == b_is_negative) {
+				limb_t carry = 0;
+				unroll<LIMBS>([&](auto i) {
+					double_limb_t current = static_cast<double_limb_t>(limbs[i]) + b.limbs[i] + carry;
+					limbs[i] = static_cast<limb_t>(current);
+					carry = static_cast<limb_t>(current >> BigInt::LIMB_BITS);
+				});
+				assert(carry == 0);
+				return;
+			}
+
+			// different signs: subtract the absolute values, a borrow means b was bigger and the difference is negated
+			limb_t borrow = 0;
+			unroll<LIMBS>([&](auto i) {
+				double_limb_t subtrahend = static_cast<double_limb_t>(b.limbs[i]) + borrow;
+				borrow = limbs[i] < subtrahend;
+				limbs[i] = static_cast<limb_t>(limbs[i] - subtrahend);
+			});
+
+			if (borrow != 0) {
+				// two's complement negation: invert all limbs and add one
+				limb_t carry = 1;
+				unroll<LIMBS>([&](auto i) {
+					double_limb_t current = static_cast<double_limb_t>(static_cast<limb_t>(~limbs[i])) + carry;
+					limbs[i] = static_cast<limb_t>(current);
+					carry = static_cast<limb_t>(current >> BigInt::LIMB_BITS);
+				});
+				is_negative = b_is_negative;
+			}
+			normalize_sign();
+		}
+
+		// the product of the highest limbs must stay below LIMBS, only used by the assert of *=
+		bool fits_product(const FixedBigInt& b) const
+		{
+			std::size_t length = LIMBS;
+			std::size_t b_length = LIMBS;
+			while (length > 0 && limbs[length - 1] == 0)
+				length--;
+			while (b_length > 0 && b.limbs[b_length - 1] == 0)
+				b_length--;
+			return length == 0 || b_length == 0 || length + b_length - 1 <= LIMBS;
+		}
+};
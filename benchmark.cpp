@@ -0,0 +1,348 @@
+#include "BigInt.h"
+#include "BigIntGcd.h"
+#include "BigIntRoot.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+// times the BigInt operations over operand sizes from 1 digit up to --max-digits in powers of ten
+// the operands of div take twice the digits, so a run up to hundreds of millions of digits needs several gigabytes
+// usage: BigIntBenchmark [--max-digits 10000000] [--min-time 0.2] [--operations add,mul,...]
+//                        [--format text|json|csv] [--output file] [--baseline old.csv] [--tolerance 0.1]
+// with --baseline every time is compared to the same operation and size of an earlier csv run,
+// the comparison goes to stderr and the exit code is 1 if anything got slower than the tolerance allows
+
+// -----------------------
+// -- Measurement
+// -----------------------
+
+// counts what the operations allocate from the default resource of the benchmark thread
+class CountingResource : public std::pmr::memory_resource
+{
+	public:
+		explicit CountingResource(std::pmr::memory_resource* upstream) : allocations(0), bytes(0), upstream(upstream) {}
+
+		std::size_t allocations;
+		std::size_t bytes;
+
+	private:
+		std::pmr::memory_resource* upstream;
+
+		void* do_allocate(std::size_t size, std::size_t alignment) override
+		{
+			allocations++;
+			bytes += size;
+			return upstream->allocate(size, alignment);
+		}
+
+		void do_deallocate(void* pointer, std::size_t size, std::size_t alignment) override
+		{
+			upstream->deallocate(pointer, size, alignment);
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+};
+
+struct Result
+{
+	std::string operation;
+	std::size_t digits;
+	std::size_t iterations;
+	double ns_per_op;
+	// operand digits processed per second
+	double digits_per_second;
+	double allocations_per_op;
+	double bytes_per_op;
+};
+
+// keeps the compiler from dropping the measured operations
+static volatile std::size_t sink = 0;
+
+// runs operation in doubling batches until min_seconds have passed, at least once
+template <typename Operation>
+static Result measure(const std::string& name, std::size_t digits, double min_seconds, Operation operation)
+{
+	typedef std::chrono::steady_clock clock;
+
+	// one untimed run fills the caches and the thread local pools
+	sink = sink + operation();
+
+	CountingResource counter(BigInt::default_resource());
+	std::size_t iterations = 0;
+	double seconds = 0;
+	{
+		BigInt::ResourceScope scope(&counter);
+		clock::time_point start = clock::now();
+		for (std::size_t batch = 1; iterations == 0 || seconds < min_seconds; batch *= 2) {
+			for (std::size_t i = 0; i < batch; i++)
+				sink = sink + operation();
+			iterations += batch;
+			seconds = std::chrono::duration<double>(clock::now() - start).count();
+		}
+	}
+
+	Result result;
+	result.operation = name;
+	result.digits = digits;
+	result.iterations = iterations;
+	result.ns_per_op = seconds * 1e9 / iterations;
+	result.digits_per_second = digits * iterations / seconds;
+	result.allocations_per_op = static_cast<double>(counter.allocations) / iterations;
+	result.bytes_per_op = static_cast<double>(counter.bytes) / iterations;
+	return result;
+}
+
+// -----------------------
+// -- Operations
+// -----------------------
+
+static std::string random_digits(std::size_t digits)
+{
+	std::string text(digits, '0');
+	for (char& digit : text)
+		digit = static_cast<char>('0' + rand() % 10);
+	text[0] = static_cast<char>('1' + rand() % 9);
+	return text;
+}
+
+static BigInt parse(const std::string& text)
+{
+	BigInt value = 0;
+	from_chars(text.data(), text.data() + text.size(), value);
+	return value;
+}
+
+static bool is_selected(const std::vector<std::string>& operations, const std::string& name)
+{
+	if (operations.empty())
+		return true;
+	for (const std::string& operation : operations) {
+		if (operation == name)
+			return true;
+	}
+	return false;
+}
+
+static std::vector<Result> run(std::size_t max_digits, double min_seconds, const std::vector<std::string>& operations)
+{
+	// powers of ten and max_digits itself, e.g. 1 to 10^8 and 3 * 10^8 for --max-digits 300000000
+	std::vector<std::size_t> sizes;
+	for (std::size_t digits = 1; digits <= max_digits && digits <= SIZE_MAX / 10; digits *= 10)
+		sizes.push_back(digits);
+	if (max_digits > 0 && sizes.back() != max_digits)
+		sizes.push_back(max_digits);
+
+	std::vector<Result> results;
+	for (std::size_t digits : sizes) {
+		std::string text = random_digits(digits);
+		BigInt a = parse(text);
+		BigInt b = parse(random_digits(digits));
+		// same length as a and only different in the lowest limb, the worst case of cmp
+		BigInt a_plus_one = a + 1;
+		// the dividend has twice the digits of the divisor
+		BigInt dividend = parse(random_digits(2 * digits));
+
+		std::vector<char> buffer(digits + 2);
+
+		auto add_result = [&](const std::string& name, auto operation) {
+			if (!is_selected(operations, name))
+				return;
+			results.push_back(measure(name, digits, min_seconds, operation));
+			cerr << name << " " << digits << " digits: " << results.back().ns_per_op << " ns" << endl;
+		};
+
+		// construction is a copy of a value with this many digits: allocation and limb copy
+		add_result("construct", [&] { BigInt copy(a); return static_cast<std::size_t>(copy.cmp(b) + 1); });
+		add_result("add", [&] { BigInt sum = a + b; return static_cast<std::size_t>(sum.cmp(a) + 1); });
+		add_result("sub", [&] { BigInt difference = a - b; return static_cast<std::size_t>(difference.cmp(a) + 1); });
+		add_result("mul", [&] { BigInt product = a * b; return static_cast<std::size_t>(product.cmp(a) + 1); });
+		add_result("square", [&] { BigInt product = square(a); return static_cast<std::size_t>(product.cmp(a) + 1); });
+		add_result("pow10", [&] { BigInt power = power_of_ten(digits); return static_cast<std::size_t>(power.cmp(a) + 1); });
+		add_result("div", [&] { BigInt quotient = dividend / a; return static_cast<std::size_t>(quotient.cmp(b) + 1); });
+		add_result("gcd", [&] { BigInt divisor = gcd(a, b); return static_cast<std::size_t>(divisor.cmp(a) + 1); });
+		add_result("sqrt", [&] { BigInt root = isqrt(a); return static_cast<std::size_t>(root.cmp(a) + 1); });
+		add_result("cmp", [&] { return static_cast<std::size_t>(a.cmp(a_plus_one) + 1); });
+		add_result("parse", [&] { BigInt value = parse(text); return static_cast<std::size_t>(value.cmp(a) + 1); });
+		add_result("print", [&] { return static_cast<std::size_t>(to_chars(buffer.data(), buffer.data() + buffer.size(), a).ptr - buffer.data()); });
+	}
+	return results;
+}
+
+// -----------------------
+// -- Output
+// -----------------------
+
+static void write_text(std::ostream& os, const std::vector<Result>& results)
+{
+	os << std::left << std::setw(10) << "operation" << std::right << std::setw(10) << "digits" << std::setw(12) << "iterations"
+		<< std::setw(16) << "ns/op" << std::setw(16) << "digits/s" << std::setw(12) << "allocs/op" << std::setw(14) << "bytes/op" << endl;
+	for (const Result& result : results) {
+		os << std::left << std::setw(10) << result.operation << std::right << std::setw(10) << result.digits << std::setw(12) << result.iterations
+			<< std::setw(16) << std::fixed << std::setprecision(1) << result.ns_per_op
+			<< std::setw(16) << std::scientific << std::setprecision(3) << result.digits_per_second
+			<< std::setw(12) << std::fixed << std::setprecision(2) << result.allocations_per_op
+			<< std::setw(14) << std::setprecision(0) << result.bytes_per_op << endl;
+	}
+}
+
+static void write_csv(std::ostream& os, const std::vector<Result>& results)
+{
+	os << "operation,digits,iterations,ns_per_op,digits_per_second,allocations_per_op,bytes_per_op" << endl;
+	os << std::setprecision(10);
+	for (const Result& result : results) {
+		os << result.operation << ',' << result.digits << ',' << result.iterations << ',' << result.ns_per_op << ','
+			<< result.digits_per_second << ',' << result.allocations_per_op << ',' << result.bytes_per_op << endl;
+	}
+}
+
+static void write_json(std::ostream& os, const std::vector<Result>& results)
+{
+	os << std::setprecision(10) << "[" << endl;
+	for (std::size_t i = 0; i < results.size(); i++) {
+		const Result& result = results[i];
+		os << "  {\"operation\": \"" << result.operation << "\", \"digits\": " << result.digits << ", \"iterations\": " << result.iterations
+			<< ", \"ns_per_op\": " << result.ns_per_op << ", \"digits_per_second\": " << result.digits_per_second
+			<< ", \"allocations_per_op\": " << result.allocations_per_op << ", \"bytes_per_op\": " << result.bytes_per_op << "}"
+			<< (i + 1 < results.size() ? "," : "") << endl;
+	}
+	os << "]" << endl;
+}
+
+// -----------------------
+// -- Baseline comparison
+// -----------------------
+
+// reads ns_per_op by operation and digits from a csv written by write_csv
+static bool read_baseline(const std::string& path, std::map<std::pair<std::string, std::size_t>, double>& baseline)
+{
+	std::ifstream file(path);
+	if (!file)
+		return false;
+
+	std::string line;
+	std::getline(file, line);
+	while (std::getline(file, line)) {
+		std::istringstream fields(line);
+		std::string operation, digits, iterations, ns_per_op;
+		if (std::getline(fields, operation, ',') && std::getline(fields, digits, ',') && std::getline(fields, iterations, ',') && std::getline(fields, ns_per_op, ','))
+			baseline[{ operation, std::strtoull(digits.c_str(), nullptr, 10) }] = std::strtod(ns_per_op.c_str(), nullptr);
+	}
+	return true;
+}
+
+// prints the change of every time against the baseline and returns the number of regressions
+static std::size_t compare(const std::vector<Result>& results, const std::map<std::pair<std::string, std::size_t>, double>& baseline, double tolerance)
+{
+	std::size_t regressions = 0;
+	cerr << std::left << std::setw(10) << "operation" << std::right << std::setw(10) << "digits" << std::setw(16) << "baseline ns"
+		<< std::setw(16) << "ns" << std::setw(10) << "change" << endl;
+	for (const Result& result : results) {
+		auto entry = baseline.find({ result.operation, result.digits });
+		if (entry == baseline.end() || entry->second <= 0)
+			continue;
+
+		double change = result.ns_per_op / entry->second - 1;
+		bool is_regression = change > tolerance;
+		regressions += is_regression;
+		cerr << std::left << std::setw(10) << result.operation << std::right << std::setw(10) << result.digits
+			<< std::setw(16) << std::fixed << std::setprecision(1) << entry->second << std::setw(16) << result.ns_per_op
+			<< std::setw(9) << std::showpos << change * 100 << std::noshowpos << "%" << (is_regression ? "  REGRESSION" : "") << endl;
+	}
+	cerr << regressions << " regression(s) above " << tolerance * 100 << "%" << endl;
+	return regressions;
+}
+
+// -----------------------
+// -- Main
+// -----------------------
+
+int main(int argc, char** argv)
+{
+	std::size_t max_digits = 10000000;
+	double min_seconds = 0.2;
+	double tolerance = 0.1;
+	std::string format = "text";
+	std::string output_path;
+	std::string baseline_path;
+	std::vector<std::string> operations;
+
+	for (int i = 1; i < argc; i++) {
+		std::string option = argv[i];
+		if (i + 1 >= argc) {
+			cerr << "missing value for " << option << endl;
+			return 2;
+		}
+
+		std::string value = argv[++i];
+		if (option == "--max-digits")
+			max_digits = std::strtoull(value.c_str(), nullptr, 10);
+		else if (option == "--min-time")
+			min_seconds = std::strtod(value.c_str(), nullptr);
+		else if (option == "--tolerance")
+			tolerance = std::strtod(value.c_str(), nullptr);
+		else if (option == "--format")
+			format = value;
+		else if (option == "--output")
+			output_path = value;
+		else if (option == "--baseline")
+			baseline_path = value;
+		else if (option == "--operations") {
+			std::istringstream names(value);
+			for (std::string name; std::getline(names, name, ',');)
+				operations.push_back(name);
+		}
+		else {
+			cerr << "unknown option " << option << endl;
+			return 2;
+		}
+	}
+
+	if (format != "text" && format != "csv" && format != "json") {
+		cerr << "unknown format " << format << ", use text, csv or json" << endl;
+		return 2;
+	}
+
+	std::map<std::pair<std::string, std::size_t>, double> baseline;
+	if (!baseline_path.empty() && !read_baseline(baseline_path, baseline)) {
+		cerr << "cannot read baseline " << baseline_path << endl;
+		return 2;
+	}
+
+	srand(42);
+	std::vector<Result> results = run(max_digits, min_seconds, operations);
+
+	std::ofstream file;
+	if (!output_path.empty())
+		file.open(output_path);
+	std::ostream& os = output_path.empty() ? cout : file;
+
+	if (format == "csv")
+		write_csv(os, results);
+	else if (format == "json")
+		write_json(os, results);
+	else
+		write_text(os, results);
+
+	if (!baseline_path.empty() && compare(results, baseline, tolerance) > 0)
+		return 1;
+
+	return 0;
+}
@@ -1,6 +1,22 @@
 #include <iostream>
 #include "BigInt.h"
+#include "BigIntBatch.h"
+#include "BigIntConstant.h"
+#include "BigIntGcd.h"
+#include "BigIntMod.h"
+#include "BigIntRoot.h"
+#include "BigIntStats.h"
+#include "BigIntView.h"
+#include "FixedBigInt.h"
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <string>
 
 using namespace std;
 
@@ -9,7 +25,7 @@ static void test_init(long int value) {
 	cout << "test_init(" << value << ") = " << b1 << endl;
 }
 
-static void test_init(unsigned short* digits, unsigned short length, bool is_negative) {
+static void test_init(unsigned short* digits, std::size_t length, bool is_negative) {
 	BigInt b1 = BigInt(digits, length, is_negative);
 	cout << "test_init(digits, " << length << ", " << is_negative << ") = " << b1 << endl;
 }
@@ -64,6 +80,100 @@ static void test_assignment() {
 	test_assignment(BigInt(-10));
 }
 
+// builds a BigInt from a decimal string, most significant digit first
+static BigInt from_decimal(const char* text, bool is_negative = false) {
+	std::size_t length = strlen(text);
+	unsigned short* digits = new unsigned short[length];
+	for (std::size_t i = 0; i < length; i++)
+		digits[i] = text[length - i - 1] - '0';
+	return BigInt(digits, length, is_negative);
+}
+
+static void test_move() {
+	cout << "--- --- test_move --- ---" << endl;
+
+	BigInt source{ -123 };
+	BigInt moved{ std::move(source) };
+	cout << "moved: (" << moved << ") source: (" << source << ")" << endl;
+
+	BigInt assigned{ 7 };
+	assigned = std::move(moved);
+	cout << "assigned: (" << assigned << ")" << endl;
+
+	// the moved from objects are still usable
+	source += 5;
+	cout << "source += 5: (" << source << ")" << endl;
+
+	BigInt self{ 21 };
+	self += self;
+	cout << "self += self: (" << self << ")" << endl;
+	self -= self;
+	cout << "self -= self: (" << self << ")" << endl;
+
+	// moves between values stored inline and on the heap
+	BigInt big = from_decimal("123456789012345678901234567890123456789012345678901234567890");
+	BigInt small{ 42 };
+	small = std::move(big);
+	big = BigInt{ 17 };
+	cout << "small: (" << small << ") big: (" << big << ")" << endl;
+	small -= from_decimal("123456789012345678901234567890123456789012345678901234567800");
+	small.shrink_to_fit();
+	BigInt moved_small{ std::move(small) };
+	cout << "moved_small: (" << moved_small << ") small: (" << small << ")" << endl;
+
+	BigInt b{ 10 };
+	cout << "10 - (3 + 4) = " << b - (BigInt{ 3 } + BigInt{ 4 }) << endl;
+	cout << "10 + (3 - 40) = " << b + (BigInt{ 3 } - BigInt{ 40 }) << endl;
+}
+
+static void test_reserve() {
+	cout << "--- --- test_reserve --- ---" << endl;
+
+	BigInt sum{ 1 };
+	sum.reserve(100);
+	// every addition doubles the value, so the length grows limb by limb
+	for (int i = 0; i < 200; i++)
+		sum += sum;
+	BigInt expected{ 1 };
+	for (int i = 0; i < 200; i++)
+		expected *= 2;
+	cout << (sum == expected ? "PASSED" : "ERROR") << " 2^200 by doubling = " << sum << endl;
+
+	sum -= expected - 1;
+	sum.shrink_to_fit();
+	cout << (sum == 1 ? "PASSED" : "ERROR") << " shrink_to_fit keeps the value: " << sum << endl;
+}
+
+static void test_resource() {
+	cout << "--- --- test_resource --- ---" << endl;
+
+	BigInt expected{ 1 };
+	for (int i = 0; i < 64; i++)
+		expected *= 1000003;
+
+	// all temporaries of the loop come from the arena, which is released at once
+	std::pmr::monotonic_buffer_resource arena;
+	BigInt product{ 1, &arena };
+	{
+		BigInt::ResourceScope scope(&arena);
+		for (int i = 0; i < 64; i++)
+			product *= 1000003;
+		BigInt quotient = product / 1000003;
+		cout << (quotient * 1000003 == product ? "PASSED" : "ERROR") << " division inside the arena scope" << endl;
+	}
+	cout << (product.get_resource() == &arena && product == expected ? "PASSED" : "ERROR") << " product allocated from the arena" << endl;
+
+	// a copy outside the scope goes back to the default resource and may outlive the arena
+	BigInt copy = product;
+	cout << (copy.get_resource() == BigInt::default_resource() && copy == expected ? "PASSED" : "ERROR") << " copy uses the default resource" << endl;
+
+	// moving between different resources has to copy
+	std::pmr::unsynchronized_pool_resource pool;
+	BigInt pooled{ 0, &pool };
+	pooled = std::move(product);
+	cout << (pooled.get_resource() == &pool && pooled == expected ? "PASSED" : "ERROR") << " move into a pool resource" << endl;
+}
+
 static void test_cmp(BigInt b1, BigInt b2) {
 	cout << "b1(" << b1 << ").cmp(" << b2 << ") = " << b1.cmp(b2) << endl;
 }
@@ -263,6 +373,864 @@ static void test_div()
 	test_div(BigInt{ 1000 }, BigInt{ 99 });
 }
 
+static void test_multi_limb() {
+	cout << "--- --- test_multi_limb --- ---" << endl;
+
+	// 2^100 goes far beyond one limb
+	BigInt power{ 1 };
+	for (int i = 0; i < 100; i++)
+		power *= 2;
+	BigInt expected = from_decimal("1267650600228229401496703205376");
+	cout << (power == expected ? "PASSED" : "ERROR") << " 2^100 = " << power << endl;
+
+	// carry propagation across limb boundaries
+	BigInt almost = from_decimal("18446744073709551615");
+	BigInt sum = almost + 1;
+	cout << (sum == from_decimal("18446744073709551616") ? "PASSED" : "ERROR") << " " << almost << " + 1 = " << sum << endl;
+	cout << (sum - 1 == almost ? "PASSED" : "ERROR") << " " << sum << " - 1 = " << sum - 1 << endl;
+
+	// decimal chunks with inner zeros
+	BigInt zeros = from_decimal("1000000000000000000000000000001", true);
+	cout << zeros << endl;
+	cout << (zeros * zeros == from_decimal("1000000000000000000000000000002000000000000000000000000000001") ? "PASSED" : "ERROR") << " " << zeros << " * " << zeros << " = " << zeros * zeros << endl;
+}
+
+// builds a random positive BigInt with the given amount of decimal digits
+static BigInt random_big(std::size_t length) {
+	unsigned short* digits = new unsigned short[length];
+	for (std::size_t i = 0; i < length; i++)
+		digits[i] = rand() % 10;
+	digits[length - 1] = 1 + rand() % 9;
+	return BigInt(digits, length, false);
+}
+
+static void test_mult_algorithms(unsigned short length_1, unsigned short length_2) {
+	BigInt b1 = random_big(length_1);
+	BigInt b2 = random_big(length_2);
+
+	// thresholds above the operand sizes force the schoolbook multiplication
+	std::size_t karatsuba_threshold = BigInt::karatsuba_threshold;
+	std::size_t toom3_threshold = BigInt::toom3_threshold;
+	std::size_t ntt_threshold = BigInt::ntt_threshold;
+	BigInt::karatsuba_threshold = 1 << 30;
+	BigInt::toom3_threshold = 1 << 30;
+	BigInt::ntt_threshold = 1 << 30;
+	BigInt expected = b1 * b2;
+
+	// low thresholds so the recursion goes through karatsuba and toom-3 a few times
+	BigInt::karatsuba_threshold = 4;
+	BigInt::toom3_threshold = 12;
+	BigInt recursive = b1 * b2;
+
+	BigInt::ntt_threshold = 1;
+	BigInt transformed = b1 * b2;
+
+	BigInt::karatsuba_threshold = karatsuba_threshold;
+	BigInt::toom3_threshold = toom3_threshold;
+	BigInt::ntt_threshold = ntt_threshold;
+
+	cout << (recursive == expected ? "PASSED" : "ERROR") << " karatsuba/toom-3 multiplication of " << length_1 << " and " << length_2 << " digits" << endl;
+	cout << (transformed == expected ? "PASSED" : "ERROR") << " ntt multiplication of " << length_1 << " and " << length_2 << " digits" << endl;
+}
+
+static void test_mult_algorithms() {
+	cout << "--- --- test_mult_algorithms --- ---" << endl;
+	test_mult_algorithms(50, 50);
+	test_mult_algorithms(100, 90);
+	test_mult_algorithms(500, 500);
+	test_mult_algorithms(1000, 301);
+	test_mult_algorithms(2000, 1999);
+	test_mult_algorithms(3000, 40);
+	test_mult_algorithms(1, 1);
+	test_mult_algorithms(9, 10);
+}
+
+// squares of one operand have to match the product of two equal copies, for every algorithm
+static void test_square(unsigned short length) {
+	BigInt b = random_big(length);
+	BigInt copy = b;
+
+	std::size_t karatsuba_threshold = BigInt::karatsuba_square_threshold;
+	std::size_t toom3_threshold = BigInt::toom3_threshold;
+	std::size_t ntt_threshold = BigInt::ntt_threshold;
+	BigInt expected = b * copy;
+
+	std::size_t thresholds[3][3] = {
+		{ 1 << 30, 1 << 30, 1 << 30 },
+		{ 4, 12, 1 << 30 },
+		{ 4, 12, 1 },
+	};
+	bool is_correct = true;
+	for (auto& threshold : thresholds) {
+		BigInt::karatsuba_square_threshold = threshold[0];
+		BigInt::toom3_threshold = threshold[1];
+		BigInt::ntt_threshold = threshold[2];
+
+		BigInt in_place = BigInt(0) - b;
+		in_place *= in_place;
+		is_correct = is_correct && square(b) == expected && BigInt(b * b) == expected && in_place == expected;
+	}
+
+	BigInt::karatsuba_square_threshold = karatsuba_threshold;
+	BigInt::toom3_threshold = toom3_threshold;
+	BigInt::ntt_threshold = ntt_threshold;
+
+	cout << (is_correct ? "PASSED" : "ERROR") << " square of " << length << " digits" << endl;
+}
+
+static void test_square() {
+	cout << "--- --- test_square --- ---" << endl;
+	cout << (square(BigInt(0)) == 0 ? "PASSED" : "ERROR") << " square of 0" << endl;
+	cout << (square(BigInt(-7)) == 49 ? "PASSED" : "ERROR") << " square of -7" << endl;
+	test_square(1);
+	test_square(10);
+	test_square(77);
+	test_square(500);
+	test_square(3001);
+}
+
+// the parallel sub-products have to give the same result as the serial multiplication
+static void test_parallel_mult(unsigned short length_1, unsigned short length_2) {
+	BigInt b1 = random_big(length_1);
+	BigInt b2 = random_big(length_2);
+	BigInt expected = b1 * b2;
+
+	std::size_t thread_count = BigInt::thread_count;
+	std::size_t parallel_threshold = BigInt::parallel_threshold;
+	std::size_t karatsuba_threshold = BigInt::karatsuba_threshold;
+	std::size_t toom3_threshold = BigInt::toom3_threshold;
+	std::size_t ntt_threshold = BigInt::ntt_threshold;
+	BigInt::thread_count = 4;
+	BigInt::parallel_threshold = 8;
+
+	// low thresholds so the recursion goes through karatsuba and toom-3 a few times
+	BigInt::karatsuba_threshold = 4;
+	BigInt::toom3_threshold = 12;
+	BigInt recursive = b1 * b2;
+
+	BigInt::ntt_threshold = 16;
+	BigInt transformed = b1 * b2;
+
+	BigInt::thread_count = thread_count;
+	BigInt::parallel_threshold = parallel_threshold;
+	BigInt::karatsuba_threshold = karatsuba_threshold;
+	BigInt::toom3_threshold = toom3_threshold;
+	BigInt::ntt_threshold = ntt_threshold;
+
+	bool passed = recursive == expected && transformed == expected;
+	cout << (passed ? "PASSED" : "ERROR") << " parallel multiplication of " << length_1 << " and " << length_2 << " digits" << endl;
+}
+
+static void test_parallel_mult() {
+	cout << "--- --- test_parallel_mult --- ---" << endl;
+	test_parallel_mult(500, 500);
+	test_parallel_mult(2000, 1999);
+	test_parallel_mult(5000, 300);
+}
+
+// the fused multiply-add expressions have to match the step by step evaluation
+static void test_fused(const BigInt& a, const BigInt& b, const BigInt& c) {
+	BigInt product = b;
+	product *= c;
+	BigInt sum = a;
+	sum += product;
+	BigInt difference = a;
+	difference -= product;
+
+	BigInt in_place = a;
+	in_place -= in_place * b;
+	BigInt expected_in_place = a;
+	expected_in_place *= b;
+	expected_in_place = a - expected_in_place;
+
+	bool passed = a + b * c == sum && b * c + a == sum && a - b * c == difference && b * c - a == BigInt{ 0 } - difference;
+	passed = passed && b * c + b * c == sum - a + product && in_place == expected_in_place;
+	cout << (passed ? "PASSED" : "ERROR") << " " << a << " +- " << b << " * " << c << endl;
+}
+
+static void test_fused() {
+	cout << "--- --- test_fused --- ---" << endl;
+	test_fused(BigInt{ 0 }, BigInt{ 0 }, BigInt{ 5 });
+	test_fused(BigInt{ 7 }, BigInt{ 3 }, BigInt{ -2 });
+	test_fused(BigInt{ -7 }, BigInt{ 3 }, BigInt{ -2 });
+	test_fused(BigInt{ 6 }, BigInt{ 3 }, BigInt{ 2 });
+	test_fused(random_big(40), random_big(30), random_big(50));
+	test_fused(random_big(900), random_big(400), random_big(500) * -1);
+	test_fused(random_big(30), random_big(400), random_big(500));
+}
+
+static void test_mod(BigInt b1, BigInt b2)
+{
+	cout << b1 << " % " << b2 << " = " << (b1 % b2) << endl;
+	cout << b2 << " % " << b1 << " = " << (b2 % b1) << endl;
+	cout << b1 << " %= " << b2 << " = ";
+	b1 %= b2;
+	cout << b1 << endl;
+}
+
+static void test_mod()
+{
+	cout << "--- --- test_mod --- ---" << endl;
+	test_mod(BigInt{ 4 }, BigInt{ 2 });
+	test_mod(BigInt{ 15 }, BigInt{ 4 });
+	test_mod(BigInt{ -15 }, BigInt{ 4 });
+	test_mod(BigInt{ 15 }, BigInt{ -4 });
+	test_mod(BigInt{ -15 }, BigInt{ -4 });
+	test_mod(BigInt{ 1 }, BigInt{ 1 });
+	test_mod(BigInt{ 101 }, BigInt{ 102 });
+	test_mod(BigInt{ 1000 }, BigInt{ 99 });
+}
+
+// checks dividend == quotient * divisor + remainder with |remainder| < |divisor|
+static void test_div_algorithms(const BigInt& dividend, const BigInt& divisor) {
+	std::pair<BigInt, BigInt> result = divmod(dividend, divisor);
+	bool remainder_smaller = result.second.cmp_absolute(divisor) > 0;
+	bool remainder_sign = result.second == 0 || (result.second < 0) == (dividend < 0);
+	bool passed = result.first * divisor + result.second == dividend && remainder_smaller && remainder_sign;
+	cout << (passed ? "PASSED" : "ERROR") << " divmod(" << dividend << ", " << divisor << ") = (" << result.first << ", " << result.second << ")" << endl;
+}
+
+static void test_div_algorithms(unsigned short length_1, unsigned short length_2) {
+	BigInt dividend = random_big(length_1);
+	BigInt divisor = random_big(length_2);
+
+	// a low threshold forces the newton division on small operands
+	std::size_t newton_division_threshold = BigInt::newton_division_threshold;
+	BigInt::newton_division_threshold = 1 << 30;
+	std::pair<BigInt, BigInt> expected = divmod(dividend, divisor);
+	BigInt::newton_division_threshold = 2;
+	std::pair<BigInt, BigInt> actual = divmod(dividend, divisor);
+	BigInt::newton_division_threshold = newton_division_threshold;
+
+	bool passed = expected.first == actual.first && expected.second == actual.second && expected.first * divisor + expected.second == dividend;
+	cout << (passed ? "PASSED" : "ERROR") << " division of " << length_1 << " by " << length_2 << " digits" << endl;
+}
+
+static void test_div_algorithms() {
+	cout << "--- --- test_div_algorithms --- ---" << endl;
+	test_div_algorithms(from_decimal("1234567890123456789012345678901234567890"), BigInt{ 7 });
+	test_div_algorithms(from_decimal("1234567890123456789012345678901234567890", true), BigInt{ 7 });
+	test_div_algorithms(from_decimal("340282366920938463463374607431768211455"), from_decimal("18446744073709551616"));
+	test_div_algorithms(from_decimal("340282366920938463463374607431768211456"), from_decimal("18446744073709551615", true));
+	test_div_algorithms(100, 40);
+	test_div_algorithms(500, 250);
+	test_div_algorithms(2000, 1000);
+	test_div_algorithms(3000, 200);
+	test_div_algorithms(3000, 2990);
+}
+
+static void test_string(const char* text, const char* expected) {
+	std::string converted = to_string(from_string(text));
+	cout << (converted == expected ? "PASSED" : "ERROR") << " from_string(\"" << text << "\") = " << converted << endl;
+}
+
+static void test_string(unsigned short length) {
+	BigInt b = random_big(length);
+	b = b * b;
+
+	// a huge threshold keeps the conversion at repeated short divisions and multiplications
+	std::size_t conversion_threshold = BigInt::conversion_threshold;
+	BigInt::conversion_threshold = 1 << 30;
+	std::string expected = to_string(b);
+	BigInt::conversion_threshold = 2;
+	std::string recursive = to_string(b);
+	BigInt parsed = from_string(expected);
+	BigInt::conversion_threshold = conversion_threshold;
+
+	cout << (recursive == expected ? "PASSED" : "ERROR") << " divide and conquer printing of " << expected.size() << " digits" << endl;
+	cout << (parsed == b ? "PASSED" : "ERROR") << " divide and conquer parsing of " << expected.size() << " digits" << endl;
+}
+
+static void test_string() {
+	cout << "--- --- test_string --- ---" << endl;
+	test_string("0", "0");
+	test_string("-0", "0");
+	test_string("42", "42");
+	test_string("-42", "-42");
+	test_string("000123", "123");
+	test_string("4294967296", "4294967296");
+	test_string("-1000000000000000000000000000001", "-1000000000000000000000000000001");
+
+	char buffer[8];
+	std::to_chars_result printed = to_chars(buffer, buffer + sizeof(buffer), BigInt{ -1234567 });
+	cout << (printed.ec == std::errc() && std::string(buffer, printed.ptr) == "-1234567" ? "PASSED" : "ERROR") << " to_chars fills a buffer of 8 chars" << endl;
+	printed = to_chars(buffer, buffer + sizeof(buffer), BigInt{ 123456789 });
+	cout << (printed.ec == std::errc::value_too_large ? "PASSED" : "ERROR") << " to_chars reports a too small buffer" << endl;
+
+	BigInt parsed{ 7 };
+	const char* text = "-x";
+	std::from_chars_result result = from_chars(text, text + 2, parsed);
+	cout << (result.ec == std::errc::invalid_argument && result.ptr == text && parsed == 7 ? "PASSED" : "ERROR") << " from_chars rejects \"-x\"" << endl;
+	text = "981x";
+	result = from_chars(text, text + 4, parsed);
+	cout << (result.ec == std::errc() && result.ptr == text + 3 && parsed == 981 ? "PASSED" : "ERROR") << " from_chars stops at the first non digit" << endl;
+
+	std::size_t rejected = 0;
+	for (const char* invalid : { "12x", "abc", "", "-", " 1" }) {
+		try {
+			from_string(invalid);
+		}
+		catch (const std::invalid_argument&) {
+			rejected++;
+		}
+	}
+	cout << (rejected == 5 ? "PASSED" : "ERROR") << " from_string throws std::invalid_argument for text that is not a number" << endl;
+
+	test_string(100);
+	test_string(3000);
+	test_string(20000);
+}
+
+// results of the vector kernels have to match the portable loops, levels the cpu lacks fall back to them
+static void test_simd(BigInt::SimdLevel level, const char* name) {
+	BigInt::SimdLevel simd_level = BigInt::simd_level;
+
+	// 2^1280 has 40 limbs, its predecessor is all ones and lets every carry and borrow ripple through
+	BigInt power{ 1 };
+	for (int i = 0; i < 80; i++)
+		power *= 65536;
+	BigInt a = random_big(600);
+	BigInt b = random_big(580);
+	std::string text = to_string(a);
+
+	BigInt::simd_level = BigInt::SIMD_PORTABLE;
+	BigInt expected_sum = a + b;
+	BigInt expected_difference = b - a;
+	BigInt expected_carry = (power - 1) + 1;
+	BigInt expected_borrow = power - 1;
+	BigInt expected_parsed = from_string(text);
+
+	BigInt::simd_level = level;
+	bool passed = a + b == expected_sum && b - a == expected_difference;
+	passed = passed && (power - 1) + 1 == expected_carry && power - 1 == expected_borrow && power - 1 < power;
+	passed = passed && from_string(text) == expected_parsed && a > b && a != a + 1;
+	BigInt::simd_level = simd_level;
+
+	cout << (passed ? "PASSED" : "ERROR") << " " << name << " kernels" << endl;
+}
+
+static void test_simd() {
+	cout << "--- --- test_simd --- ---" << endl;
+	test_simd(BigInt::SIMD_PORTABLE, "portable");
+	test_simd(BigInt::SIMD_AVX2, "avx2");
+	test_simd(BigInt::SIMD_AVX512, "avx512");
+}
+
+// square and multiply with plain BigInt operations as reference
+static BigInt pow_mod_reference(BigInt base, BigInt exponent, const BigInt& modulus) {
+	BigInt result{ 1 };
+	base %= modulus;
+	while (exponent > 0) {
+		if (exponent % 2 == 1)
+			result = result * base % modulus;
+		base = base * base % modulus;
+		exponent /= 2;
+	}
+	result %= modulus;
+	return result < 0 ? result + modulus : result;
+}
+
+static void test_modular(const BigInt& modulus, const BigInt& a, const BigInt& b, const BigInt& exponent, const char* name) {
+	BigIntModContext context(modulus);
+	BigInt a_reduced = a % modulus < 0 ? a % modulus + modulus : a % modulus;
+	BigInt b_reduced = b % modulus < 0 ? b % modulus + modulus : b % modulus;
+
+	bool passed = context.reduce(a) == a_reduced;
+	passed = passed && context.mul(a, b) == a_reduced * b_reduced % modulus;
+	passed = passed && context.square(b) == b_reduced * b_reduced % modulus;
+	passed = passed && context.pow(a, exponent) == pow_mod_reference(a, exponent, modulus);
+	passed = passed && context.pow(a, 0) == 1 && context.pow(b, 1) == b_reduced;
+	cout << (passed ? "PASSED" : "ERROR") << " modular arithmetic with " << name << endl;
+}
+
+// counts what is allocated from the default resource of the calling thread while it is in use
+class CountingResource : public std::pmr::memory_resource
+{
+	public:
+		explicit CountingResource(std::pmr::memory_resource* upstream) : allocations(0), upstream(upstream) {}
+
+		std::size_t allocations;
+
+	private:
+		std::pmr::memory_resource* upstream;
+
+		void* do_allocate(std::size_t size, std::size_t alignment) override
+		{
+			allocations++;
+			return upstream->allocate(size, alignment);
+		}
+
+		void do_deallocate(void* pointer, std::size_t size, std::size_t alignment) override
+		{
+			upstream->deallocate(pointer, size, alignment);
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+};
+
+// refuses every allocation above a limit like a machine without that much memory, the rest goes upstream
+class LimitedResource : public std::pmr::memory_resource
+{
+	public:
+		LimitedResource(std::pmr::memory_resource* upstream, std::size_t limit) : largest_refused(0), upstream(upstream), limit(limit) {}
+
+		std::size_t largest_refused;
+
+	private:
+		std::pmr::memory_resource* upstream;
+		std::size_t limit;
+
+		void* do_allocate(std::size_t size, std::size_t alignment) override
+		{
+			if (size > limit) {
+				largest_refused = std::max(largest_refused, size);
+				throw std::bad_alloc();
+			}
+			return upstream->allocate(size, alignment);
+		}
+
+		void do_deallocate(void* pointer, std::size_t size, std::size_t alignment) override
+		{
+			upstream->deallocate(pointer, size, alignment);
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+};
+
+// the steps of pow must not allocate, so a longer exponent makes no more allocations, also on the karatsuba path
+static void test_modular_allocations() {
+	std::size_t saved_threshold = BigInt::karatsuba_threshold;
+	std::size_t saved_square_threshold = BigInt::karatsuba_square_threshold;
+	BigInt::karatsuba_threshold = 8;
+	BigInt::karatsuba_square_threshold = 8;
+
+	BigIntModContext context(random_big(600) * 2);
+	BigInt base = random_big(500);
+	auto count_pow = [&](const BigInt& exponent) {
+		CountingResource counter(BigInt::default_resource());
+		BigInt::ResourceScope scope(&counter);
+		BigInt result = context.pow(base, exponent);
+		std::size_t allocations = counter.allocations;
+		return result == pow_mod_reference(base, exponent, context.get_modulus()) ? allocations : SIZE_MAX;
+	};
+	std::size_t short_exponent = count_pow(random_big(60));
+	std::size_t long_exponent = count_pow(random_big(600));
+	cout << (short_exponent == long_exponent && long_exponent < 10 ? "PASSED" : "ERROR") << " pow with an even modulus makes " << long_exponent << " allocations for any exponent" << endl;
+
+	// products into a result which already has room do not allocate at all
+	BigInt result(0);
+	context.mul(base, base, result);
+	std::size_t allocations = 0;
+	{
+		CountingResource counter(BigInt::default_resource());
+		BigInt::ResourceScope scope(&counter);
+		for (int i = 0; i < 100; i++) {
+			context.mul(result, base, result);
+			context.square(result, result);
+		}
+		allocations = counter.allocations;
+	}
+	cout << (allocations == 0 ? "PASSED" : "ERROR") << " mul and square into a result make no allocations" << endl;
+
+	BigInt::karatsuba_threshold = saved_threshold;
+	BigInt::karatsuba_square_threshold = saved_square_threshold;
+}
+
+static void test_modular() {
+	cout << "--- --- test_modular --- ---" << endl;
+	test_modular(97, 1234, -5678, 1000003, "a small odd modulus");
+	test_modular(BigInt{ 1 } * 65536 * 65536, 123456789, 987654321, 77, "a power of two modulus");
+	test_modular(random_big(300) * 2 + 1, random_big(600), random_big(250) * -1, random_big(100), "an odd modulus of 300 digits");
+	test_modular(random_big(300) * 2, random_big(400) * -1, random_big(299), random_big(80), "an even modulus of 300 digits");
+	cout << (pow_mod(3, 200, 1000) == 1 ? "PASSED" : "ERROR") << " pow_mod(3, 200, 1000) = " << pow_mod(3, 200, 1000) << endl;
+	test_modular_allocations();
+}
+
+// plain euclid with the remainder operator as reference
+static BigInt gcd_reference(BigInt a, BigInt b) {
+	a = a < 0 ? BigInt(0) - a : a;
+	b = b < 0 ? BigInt(0) - b : b;
+	while (b != 0) {
+		BigInt r = a % b;
+		a = b;
+		b = r;
+	}
+	return a;
+}
+
+// gcd, the cofactors of ext_gcd and the inverse have to agree with the reference, for lehmer and half gcd
+static void test_gcd(unsigned short length_1, unsigned short length_2, const BigInt& factor, std::size_t half_gcd_threshold) {
+	BigInt a = random_big(length_1) * factor;
+	BigInt b = BigInt(0) - random_big(length_2) * factor;
+	BigInt expected = gcd_reference(a, b);
+
+	std::size_t saved_threshold = BigInt::half_gcd_threshold;
+	BigInt::half_gcd_threshold = half_gcd_threshold;
+	BigInt x(0);
+	BigInt y(0);
+	BigInt g = ext_gcd(a, b, x, y);
+	bool passed = gcd(a, b) == expected && g == expected && BigInt(a * x) + b * y == g;
+	passed = passed && x >= 0 && x < (b < 0 ? BigInt(0) - b : b) / g;
+	passed = passed && lcm(a, b) * g == (a < 0 ? BigInt(0) - a : a) * (b < 0 ? BigInt(0) - b : b);
+	BigInt modulus = b < 0 ? BigInt(0) - b : b;
+	BigInt inverse = mod_inverse(a + 1, modulus);
+	passed = passed && (inverse == 0 ? gcd_reference(a + 1, modulus) != 1 : (a + 1) * inverse % modulus == 1);
+	BigInt::half_gcd_threshold = saved_threshold;
+
+	cout << (passed ? "PASSED" : "ERROR") << " gcd of " << length_1 << " and " << length_2 << " digits, half gcd from " << half_gcd_threshold << " limbs" << endl;
+}
+
+static void test_gcd() {
+	cout << "--- --- test_gcd --- ---" << endl;
+	cout << (gcd(0, 0) == 0 && gcd(0, -12) == 12 && gcd(-18, 12) == 6 ? "PASSED" : "ERROR") << " gcd of small numbers" << endl;
+	cout << (lcm(-4, 6) == 12 && lcm(0, 5) == 0 ? "PASSED" : "ERROR") << " lcm of small numbers" << endl;
+	BigInt x(0);
+	BigInt y(0);
+	BigInt g = ext_gcd(240, 46, x, y);
+	cout << (g == 2 && x == 14 && y == -73 ? "PASSED" : "ERROR") << " ext_gcd(240, 46) = 240 * " << x << " + 46 * " << y << endl;
+	g = ext_gcd(-5, 0, x, y);
+	cout << (g == 5 && x == -1 && y == 0 ? "PASSED" : "ERROR") << " ext_gcd(-5, 0)" << endl;
+	cout << (mod_inverse(3, 11) == 4 && mod_inverse(-3, 11) == 7 && mod_inverse(6, 9) == 0 ? "PASSED" : "ERROR") << " mod_inverse of small numbers" << endl;
+	test_gcd(15, 30, 1, 1000);
+	test_gcd(300, 280, random_big(40), 1000);
+	test_gcd(2000, 2000, random_big(200), 8);
+	test_gcd(3000, 1000, 1, 16);
+}
+
+static BigInt power_reference(const BigInt& base, unsigned exponent) {
+	BigInt result = 1;
+	for (unsigned i = 0; i < exponent; i++)
+		result *= base;
+	return result;
+}
+
+// pow has to match repeated multiplication, also on the shortcuts for powers of two and ten
+static void test_pow(const BigInt& base, unsigned exponent) {
+	bool passed = pow(base, exponent) == power_reference(base, exponent);
+	cout << (passed ? "PASSED" : "ERROR") << " pow of a " << BigIntView(base).get_length() << " limb base to " << exponent << endl;
+}
+
+static void test_pow() {
+	cout << "--- --- test_pow --- ---" << endl;
+	cout << (pow(BigInt(0), 0) == 1 && pow(BigInt(0), 5) == 0 && pow(BigInt(-2), 3) == -8 && pow(BigInt(-2), 4) == 16 ? "PASSED" : "ERROR") << " pow of small numbers" << endl;
+	test_pow(3, 40);
+	test_pow(-7, 333);
+	test_pow(BigInt(1) * 65536 * 65536 * 8, 50);
+	test_pow(random_big(30) * 1024, 17);
+	test_pow(random_big(200) * -1, 64);
+	test_pow(1000, 100);
+
+	bool passed = true;
+	for (unsigned exponent : { 0, 1, 9, 100, 1151, 1152, 1153, 2304, 5000 })
+		passed = passed && power_of_ten(exponent) == power_reference(10, exponent);
+	cout << (passed ? "PASSED" : "ERROR") << " power_of_ten below and above the cached exponents" << endl;
+
+	bool is_thrown = false;
+	try {
+		// 10 bits per factor, so about 5.8e18 limbs
+		pow(BigInt(1000), UINT64_MAX);
+	}
+	catch (const std::length_error&) {
+		is_thrown = true;
+	}
+	cout << (is_thrown ? "PASSED" : "ERROR") << " pow beyond MAX_LIMBS throws std::length_error" << endl;
+
+	// exponent * 10 used to wrap around to 4 and size the result as 2 limbs, which the powers then overran
+	// the 1.9e17 limbs of the result are below MAX_LIMBS, so its allocation has to be what fails
+	LimitedResource limited(BigInt::default_resource(), std::size_t(1) << 30);
+	is_thrown = false;
+	try {
+		BigInt::ResourceScope scope(&limited);
+		power_of_ten(1844674407370955162);
+	}
+	catch (const std::bad_alloc&) {
+		is_thrown = limited.largest_refused / sizeof(BigInt::limb_t) >= 192153584101141164;
+	}
+	cout << (is_thrown ? "PASSED" : "ERROR") << " power_of_ten of a huge exponent allocates its whole result up front and throws" << endl;
+}
+
+// the roots have to be the biggest numbers whose power does not exceed the operand
+static void test_root(unsigned short length, unsigned k) {
+	BigInt a = random_big(length);
+	auto root_and_remainder = sqrtrem(a);
+	BigInt s = root_and_remainder.first;
+	BigInt r = root_and_remainder.second;
+	bool passed = isqrt(a) == s && s * s + r == a && r >= 0 && r <= s + s;
+
+	BigInt root = iroot(a, k);
+	passed = passed && power_reference(root, k) <= a && power_reference(root + 1, k) > a;
+	passed = passed && (k % 2 == 0 || iroot(BigInt(0) - a, k) == BigInt(0) - root);
+	passed = passed && is_perfect_power(power_reference(root + 2, k)) && is_perfect_power(s * s);
+
+	cout << (passed ? "PASSED" : "ERROR") << " square root and root " << k << " of " << length << " digits" << endl;
+}
+
+static void test_root() {
+	cout << "--- --- test_root --- ---" << endl;
+	cout << (isqrt(0) == 0 && isqrt(15) == 3 && isqrt(16) == 4 ? "PASSED" : "ERROR") << " isqrt of small numbers" << endl;
+	cout << (iroot(-27, 3) == -3 && iroot(80, 4) == 2 && iroot(81, 4) == 3 && iroot(5, 100) == 1 ? "PASSED" : "ERROR") << " iroot of small numbers" << endl;
+
+	BigInt base(0);
+	std::uint64_t exponent = 0;
+	bool passed = is_perfect_power(0) && is_perfect_power(1) && !is_perfect_power(12) && !is_perfect_power(-4);
+	passed = passed && is_perfect_power(-32, base, exponent) && base == -2 && exponent == 5;
+	passed = passed && is_perfect_power(power_reference(36, 15), base, exponent) && base == 6 && exponent == 30;
+	passed = passed && !is_perfect_power(power_reference(6, 30) + 1, base, exponent);
+	cout << (passed ? "PASSED" : "ERROR") << " is_perfect_power" << endl;
+
+	test_root(1, 3);
+	test_root(20, 2);
+	test_root(100, 5);
+	test_root(1000, 3);
+	test_root(4000, 7);
+}
+
+// shifts have to match multiplying and dividing by powers of two, the bitwise operators the identities of two's complement
+static void test_bits(unsigned short length, std::size_t shift) {
+	BigInt a = random_big(length);
+	BigInt b = BigInt(0) - random_big(length / 2 + 1);
+	BigInt power = pow(BigInt(2), shift);
+
+	bool passed = (a << shift) == a * power && (a << shift >> shift) == a && (a >> shift) == a / power;
+	// negative numbers round down
+	passed = passed && (b >> shift) == (b - power + 1) / power && (b << shift >> shift) == b;
+	passed = passed && (a & b) + (a | b) == a + b && (a ^ b) == (a | b) - (a & b) && (b & ~b) == 0 && (b ^ ~b) == -1;
+	passed = passed && (a & (power - 1)) == a % power && (a | (BigInt(0) - power)) == a % power - power;
+
+	BigInt c = a;
+	c.set_bit(shift);
+	c.set_bit(shift, false);
+	passed = passed && c == a - (a.test_bit(shift) ? power : BigInt(0)) && (a >> (a.bit_length() - 1)) == 1;
+
+	cout << (passed ? "PASSED" : "ERROR") << " shifts and bitwise operators on " << length << " digits by " << shift << " bits" << endl;
+}
+
+static void test_bits() {
+	cout << "--- --- test_bits --- ---" << endl;
+	cout << ((BigInt(-6) & 3) == 2 && (BigInt(-6) | 3) == -5 && (BigInt(-6) ^ 3) == -7 && ~BigInt(0) == -1 && ~BigInt(-5) == 4 ? "PASSED" : "ERROR") << " bitwise operators of small numbers" << endl;
+	cout << ((BigInt(-7) >> 1) == -4 && (BigInt(-8) >> 1) == -4 && (BigInt(-1) >> 100) == -1 && (BigInt(7) >> 100) == 0 && (BigInt(3) << 64) == BigInt(3) * 65536 * 65536 * 65536 * 65536 ? "PASSED" : "ERROR") << " shifts of small numbers" << endl;
+
+	BigInt b(-6);
+	bool passed = b.popcount() == 2 && b.bit_length() == 3 && BigInt(0).bit_length() == 0;
+	passed = passed && !b.test_bit(0) && b.test_bit(1) && !b.test_bit(2) && b.test_bit(3) && b.test_bit(1000);
+	b.set_bit(0);
+	b.set_bit(1000, false);
+	passed = passed && b == BigInt(-5) - pow(BigInt(2), 1000);
+	cout << (passed ? "PASSED" : "ERROR") << " popcount, bit_length, test_bit and set_bit" << endl;
+
+	test_bits(5, 3);
+	test_bits(100, 32);
+	test_bits(1000, 1000);
+	test_bits(3000, 777);
+}
+
+// the bulk operations have to match the same operations on single BigInts
+static void test_batch(std::size_t thread_count) {
+	std::vector<BigInt> values_1;
+	std::vector<BigInt> values_2;
+	for (int i = 0; i < 200; i++) {
+		values_1.push_back(random_big(1 + rand() % 100) * (rand() % 2 == 0 ? 1 : -1));
+		values_2.push_back(random_big(1 + rand() % 100) * (rand() % 3 - 1));
+	}
+	values_1.push_back(5);
+	values_2.push_back(-5);
+
+	std::size_t saved_thread_count = BigInt::thread_count;
+	std::size_t parallel_threshold = BigInt::parallel_threshold;
+	BigInt::thread_count = thread_count;
+	BigInt::parallel_threshold = 8;
+
+	BigIntBatch batch_1(values_1);
+	BigIntBatch batch_2(values_2);
+	BigIntBatch sums = batch_1 + batch_2;
+	BigIntBatch differences = batch_1 - batch_2;
+	BigIntBatch products = batch_1 * batch_2;
+	BigIntBatch scaled = batch_1 * values_1[0];
+	std::vector<short> cmp_results = batch_1.cmp(batch_2);
+	BigInt sum = batch_1.sum();
+	BigIntBatch sorted = batch_1;
+	sorted.sort();
+
+	BigInt::thread_count = saved_thread_count;
+	BigInt::parallel_threshold = parallel_threshold;
+
+	bool passed = sums.size() == values_1.size();
+	BigInt expected_sum{ 0 };
+	for (std::size_t i = 0; i < values_1.size() && passed; i++) {
+		passed = sums[i] == values_1[i] + values_2[i] && differences[i] == values_1[i] - values_2[i];
+		passed = passed && products[i] == values_1[i] * values_2[i] && scaled[i] == values_1[i] * values_1[0];
+		passed = passed && cmp_results[i] == values_1[i].cmp(values_2[i]);
+		expected_sum += values_1[i];
+	}
+	for (std::size_t i = 1; i < sorted.size() && passed; i++)
+		passed = sorted.cmp(i - 1, sorted, i) >= 0;
+	passed = passed && sum == expected_sum && sums[values_1.size() - 1] == 0 && batch_1.to_vector()[3] == values_1[3];
+
+	cout << (passed ? "PASSED" : "ERROR") << " batch operations on " << thread_count << " threads" << endl;
+}
+
+static void test_batch() {
+	cout << "--- --- test_batch --- ---" << endl;
+	test_batch(1);
+	test_batch(4);
+}
+
+// every operation has to give the same result as on BigInt
+static void test_fixed(const BigInt& b1, const BigInt& b2) {
+	FixedBigInt<512> f1(b1);
+	FixedBigInt<512> f2(b2);
+
+	bool passed = BigInt(f1) == b1 && f1.cmp(f2) == b1.cmp(b2) && (f1 < f2) == (b1 < b2) && (f1 == f2) == (b1 == b2);
+	passed = passed && BigInt(f1 + f2) == b1 + b2 && BigInt(f1 - f2) == b1 - b2 && BigInt(f1 * f2) == BigInt(b1 * b2);
+	passed = passed && BigInt(f1 / f2) == b1 / b2 && BigInt(f1 % f2) == b1 % b2;
+	cout << (passed ? "PASSED" : "ERROR") << " FixedBigInt<512> " << f1 << " and " << f2 << endl;
+}
+
+static void test_fixed() {
+	cout << "--- --- test_fixed --- ---" << endl;
+	test_fixed(random_big(70), random_big(75) * -1);
+	test_fixed(random_big(60) * -1, random_big(20) * -1);
+	test_fixed(random_big(150), 1);
+	test_fixed(-7, 7);
+	test_fixed(0, -3);
+
+	FixedBigInt<256> count = 0;
+	for (long int i = 1; i <= 30; i++)
+		count = count * i + i;
+	cout << (BigInt(count) == from_decimal("721032028774273509017636384693700") ? "PASSED" : "ERROR") << " FixedBigInt<256> loop " << count << endl;
+
+	// the division works on the stack like everything else
+	FixedBigInt<512> dividend(random_big(150));
+	FixedBigInt<512> divisor(random_big(40) * -1);
+	FixedBigInt<512> quotient = 0;
+	FixedBigInt<512> remainder = 0;
+	CountingResource counter(BigInt::default_resource());
+	{
+		BigInt::ResourceScope scope(&counter);
+		quotient = dividend / divisor;
+		remainder = dividend % divisor;
+	}
+	bool passed = counter.allocations == 0 && quotient * divisor + remainder == dividend;
+	cout << (passed ? "PASSED" : "ERROR") << " FixedBigInt<512> division makes no allocations" << endl;
+}
+
+// the counters only move when the library is compiled with BIGINT_STATS
+static void test_stats() {
+	cout << "--- --- test_stats --- ---" << endl;
+	BigIntStats::reset();
+	BigInt a = random_big(1000);
+	BigInt b = random_big(500);
+	BigInt product = a * b;
+	BigInt quotient = product / b;
+	bool is_equal = quotient == a;
+	BigIntStats stats = BigIntStats::snapshot();
+
+	const BigIntStats::Counters& mul = stats.operations[BigIntStats::OP_MUL];
+	const BigIntStats::Counters& div = stats.operations[BigIntStats::OP_DIV];
+	bool passed = is_equal;
+	// 1000 and 500 digits have 104 and 52 limbs
+	if (BigIntStats::is_enabled)
+		passed = passed && mul.calls == 1 && mul.limbs == 156 && div.calls == 1 && div.allocations > 0 && stats.operations[BigIntStats::OP_CMP].calls >= 1;
+	else
+		passed = passed && mul.calls == 0 && div.nanoseconds == 0;
+
+	BigIntStats::reset();
+	passed = passed && BigIntStats::snapshot().operations[BigIntStats::OP_MUL].calls == 0;
+	cout << (passed ? "PASSED" : "ERROR") << " stats " << (BigIntStats::is_enabled ? "enabled" : "disabled") << ", " << BigIntStats::operation_name(BigIntStats::OP_MUL)
+		<< ": " << mul.calls << " calls " << mul.limbs << " limbs " << mul.nanoseconds << " ns, " << BigIntStats::operation_name(BigIntStats::OP_DIV)
+		<< ": " << div.allocations << " allocations " << div.allocated_bytes << " bytes" << endl;
+}
+
+// a round trip through the wire format and the operations on a view of the serialized buffer
+static void test_serialize(const BigInt& a, const BigInt& b) {
+	std::vector<unsigned char> buffer = serialize(b);
+	BigInt copy = 7;
+	BigIntView view;
+	bool passed = deserialize(buffer.data(), buffer.size(), copy) == buffer.size() && copy == b;
+	passed = passed && view_serialized(buffer.data(), buffer.size(), view) == buffer.size() && view == b;
+	passed = passed && a.cmp(view) == a.cmp(b) && (a < view) == (a < b) && (view == b) && view.cmp_absolute(a) == b.cmp_absolute(a);
+	passed = passed && a + view == a + b && a - view == a - b && a * view == BigInt(a * b);
+	if (b != 0)
+		passed = passed && a / view == a / b && a % view == a % b;
+
+	BigInt sum = a;
+	sum += BigIntView(sum);
+	passed = passed && sum == a * 2;
+	cout << (passed ? "PASSED" : "ERROR") << " serialize " << b << " into " << buffer.size() << " bytes" << endl;
+}
+
+static void test_serialize() {
+	cout << "--- --- test_serialize --- ---" << endl;
+	test_serialize(random_big(100), random_big(50) * -1);
+	test_serialize(random_big(30) * -1, random_big(300));
+	test_serialize(12345, 0);
+
+	// truncated, unknown version and leading zero limb
+	std::vector<unsigned char> buffer = serialize(random_big(40));
+	std::vector<unsigned char> wrong_version = buffer;
+	wrong_version[0] = 2;
+	std::vector<unsigned char> leading_zero = serialize(BigInt(1));
+	leading_zero[SERIALIZED_HEADER_SIZE] = 0;
+	BigInt value = 5;
+	bool passed = deserialize(buffer.data(), buffer.size() - 1, value) == 0 && deserialize(wrong_version.data(), wrong_version.size(), value) == 0;
+	passed = passed && deserialize(leading_zero.data(), leading_zero.size(), value) == 0 && value == 5;
+	cout << (passed ? "PASSED" : "ERROR") << " invalid buffers are rejected" << endl;
+}
+
+// numbers beyond the old limit of 65535 digits and the failures of too big or failed allocations
+static void test_large() {
+	cout << "--- --- test_large --- ---" << endl;
+	BigInt a = random_big(200000);
+	BigInt square = a * a;
+	bool passed = to_string(a).size() == 200000 && square / a == a && square % a == 0;
+	cout << (passed ? "PASSED" : "ERROR") << " 200000 digits squared and divided" << endl;
+
+	BigInt value = 5;
+	bool is_thrown = false;
+	try {
+		value.reserve(BigInt::MAX_LIMBS + 1);
+	}
+	catch (const std::length_error&) {
+		is_thrown = true;
+	}
+	cout << (is_thrown && value == 5 ? "PASSED" : "ERROR") << " growing beyond MAX_LIMBS throws std::length_error" << endl;
+
+	// the null resource fails every allocation
+	BigInt small(5, std::pmr::null_memory_resource());
+	is_thrown = false;
+	try {
+		small *= random_big(100);
+	}
+	catch (const std::bad_alloc&) {
+		is_thrown = true;
+	}
+	cout << (is_thrown && small == 5 ? "PASSED" : "ERROR") << " a failed allocation throws std::bad_alloc and keeps the value" << endl;
+}
+
+// the constants are computed by the compiler, the static_asserts fail the build if they are wrong
+static void test_literal() {
+	cout << "--- --- test_literal --- ---" << endl;
+	constexpr auto a = 123456789012345678901234567890_big;
+	constexpr auto b = -0xFFFF'FFFF'FFFF'FFFF'FFFF_big;
+	static_assert(a * 1_big == a && a + b - b == a, "identities of constants");
+	static_assert(a - a == 0_big && -(b - b) == 0_big, "zero of constants");
+	static_assert(b < 0_big && b < a && a > -a && 0b1010_big == 012_big, "comparison of constants");
+	static_assert(4294967296_big * 4294967296_big == 0x1'0000'0000'0000'0000_big, "carry into a new limb");
+
+	constexpr BigIntConstant<4> c = a * a * 0_big + a;
+	BigInt product = a * b;
+	bool passed = BigInt(c) == from_decimal("123456789012345678901234567890");
+	passed = passed && product == from_decimal("123456789012345678901234567890") * from_decimal("1208925819614629174706175", true);
+	passed = passed && BigInt(b) + 1 == from_decimal("1208925819614629174706174", true);
+	cout << (passed ? "PASSED" : "ERROR") << " " << a << " * " << b << " = " << product << endl;
+}
+
 static void test_random(int amount = 10)
 {
 	srand(time(NULL));
@@ -293,7 +1261,8 @@ static void test_random(int amount = 10)
 		long result = random_3 * random_4;
 		BigInt b3{ random_3 };
 		BigInt b4{ random_4 };
-		cmp_result = (b3 * b4).cmp(result);
+		// the product is lazy, it becomes a BigInt for the comparison
+		cmp_result = BigInt(b3 * b4).cmp(result);
 		if (cmp_result != 0)
 			cout << "ERROR " << b3 << " * " << " " << b4 << ": expected (" << result << "), actual: (" << b3 * b4 << ")" << endl;
 		else
@@ -311,6 +1280,12 @@ static void test_random(int amount = 10)
 		else
 			cout << "PASSED " << b1 << " / " << " " << b2 << ": expected (" << random_1 / random_2 << "), actual: (" << b1 / b2 << ")" << endl;
 
+		cmp_result = (b1 % b2).cmp(random_1 % random_2);
+		if (cmp_result != equal)
+			cout << "ERROR " << b1 << " % " << " " << b2 << ": expected (" << random_1 % random_2 << "), actual: (" << b1 % b2 << ")" << endl;
+		else
+			cout << "PASSED " << b1 << " % " << " " << b2 << ": expected (" << random_1 % random_2 << "), actual: (" << b1 % b2 << ")" << endl;
+
 	}
 }
 
@@ -318,12 +1293,35 @@ int main() {
 	test_init();
 	test_copy();
 	test_assignment();
+	test_move();
+	test_reserve();
+	test_resource();
 	test_cmp();
 	test_equality_operators();
 	test_add();
 	test_sub();
 	test_mult();
+	test_fused();
 	test_div();
+	test_mod();
+	test_multi_limb();
+	test_mult_algorithms();
+	test_square();
+	test_pow();
+	test_parallel_mult();
+	test_div_algorithms();
+	test_string();
+	test_simd();
+	test_batch();
+	test_modular();
+	test_gcd();
+	test_root();
+	test_bits();
+	test_literal();
+	test_fixed();
+	test_stats();
+	test_serialize();
+	test_large();
 	test_random();
 
 	return 0;